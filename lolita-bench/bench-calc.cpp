@@ -0,0 +1,37 @@
+#include "benchmark.h"
+#include "calc.h"
+
+using namespace std;
+
+namespace eds::loli::bench
+{
+    // a long sum of terms with nested parentheses and all operators
+    string GenerateCalcInput(int size)
+    {
+        string result = "0";
+        for (int i = 0; result.length() < size; ++i)
+        {
+            result.append(" + (");
+            result.append(to_string(i));
+            result.append(" - 17) * (3 + ");
+            result.append(to_string(i % 100));
+            result.append(" / (2 + (5)))\n");
+        }
+
+        return result;
+    }
+
+    GrammarReport RunCalcBenchmark(const BenchmarkOptions& options)
+    {
+        auto report = GrammarReport{"calc"};
+        auto config = LoadTextFile(options.grammar_dir + "/calc.loli.txt");
+        MeasureConstruction(report, config, options);
+
+        auto parser      = calc::CreateParser(options.table_budget);
+        report.footprint = parser->Footprint();
+
+        MeasureParsing(report, *parser, GenerateInput(config, options, GenerateCalcInput), options);
+
+        return report;
+    }
+}
@@ -0,0 +1,179 @@
+#include "benchmark.h"
+#include "lang.h"
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+namespace eds::loli::bench
+{
+    namespace
+    {
+        // hash of parsing events, which tells apart parses of a different sequence of shifts and reductions
+        struct EventDigest final
+        {
+            uint64_t value = 14695981039346656037ull;
+
+            void Mix(int64_t x)
+            {
+                value = (value ^ static_cast<uint64_t>(x)) * 1099511628211ull;
+            }
+
+            void OnShift(const ast::BasicAstToken& tok)
+            {
+                Mix(tok.Offset());
+                Mix(tok.Tag());
+            }
+            void OnReduce(const ProductionInfo& production, ast::AstLocationInfo span, ArrayRef<ast::AstLocationInfo> children)
+            {
+                Mix(-1 - production.Id());
+                Mix(span.offset);
+                Mix(span.length);
+            }
+            void OnAccept()
+            {
+                Mix(-1000000);
+            }
+            void OnError(int offset)
+            {
+                Mix(-2000000 - offset);
+            }
+        };
+
+        // what a serial parse of a document yields
+        struct ExpectedParse
+        {
+            bool accepted;
+            int error_offset;
+            vector<int32_t> snapshot;
+            uint64_t events;
+        };
+
+        using LangParser = BasicParser<lang::TranslationUnit>;
+
+        bool Matches(const LangParser& parser, const ExpectedParse& expected, const ParsingResult<lang::TranslationUnit*>& result)
+        {
+            if (static_cast<bool>(result) != expected.accepted)
+                return false;
+
+            return expected.accepted
+                       ? parser.SaveSnapshot(result.value) == expected.snapshot
+                       : result.status.error_offset == expected.error_offset;
+        }
+    }
+
+    bool RunConcurrencyCheck(const BenchmarkOptions& options, ostream& output)
+    {
+        constexpr auto kDocumentCount = 64;
+        constexpr auto kReaderCount   = 3;
+
+        auto parser = lang::CreateParser(options.table_budget);
+        auto config = LoadTextFile(options.grammar_dir + "/lang.loli.txt");
+
+        // documents of different lengths, where every third one is broken so that rejections are covered as well
+        auto document_options = options;
+
+        auto documents = vector<string>{};
+        for (int i = 0; i < kDocumentCount; ++i)
+        {
+            document_options.seed       = options.seed + i;
+            document_options.input_size = max(1024, options.input_size / kDocumentCount) * (1 + i % 4);
+
+            auto document = GenerateInput(config, document_options, GenerateLangInput);
+            if (i % 3 == 2)
+                document.insert(document.length() * i / kDocumentCount, " ) ");
+
+            documents.push_back(move(document));
+        }
+
+        auto views = vector<string_view>(documents.begin(), documents.end());
+
+        // serial parses to compare with
+        auto expected = vector<ExpectedParse>{};
+        for (const auto& document : documents)
+        {
+            Arena arena;
+            auto result = parser->TryParse(arena, document);
+            auto digest = EventDigest{};
+            parser->ParseEvents(document, digest);
+
+            expected.push_back(ExpectedParse{
+                static_cast<bool>(result),
+                result.status.error_offset,
+                result ? parser->SaveSnapshot(result.value) : vector<int32_t>{},
+                digest.value});
+        }
+
+        // a batch and readers of single documents share the parser at the same time
+        atomic<int> mismatch_count = 0;
+        atomic<bool> batch_done    = false;
+
+        // NOTE an exception counts as a mismatch, so that threads are always joined
+        auto check_batch = [&]() {
+            try
+            {
+                auto batch = parser->ParseBatch(ArrayRef<const string_view>(views.data(), views.size()));
+                for (int i = 0; i < kDocumentCount; ++i)
+                {
+                    if (!Matches(*parser, expected[i], batch.results[i]))
+                        mismatch_count += 1;
+                }
+            }
+            catch (...)
+            {
+                mismatch_count += 1;
+            }
+        };
+
+        auto check_reader = [&](int id) {
+            for (int i = id; !batch_done || i < id + kDocumentCount; ++i)
+            {
+                const auto index = i % kDocumentCount;
+
+                try
+                {
+                    Arena arena;
+                    auto digest = EventDigest{};
+                    parser->ParseEvents(documents[index], digest);
+
+                    if (!Matches(*parser, expected[index], parser->TryParse(arena, documents[index])) ||
+                        digest.value != expected[index].events)
+                    {
+                        mismatch_count += 1;
+                    }
+                }
+                catch (...)
+                {
+                    mismatch_count += 1;
+                }
+            }
+        };
+
+        for (int round = 0; round < options.iterations; ++round)
+        {
+            batch_done = false;
+
+            auto readers = vector<thread>{};
+            for (int id = 0; id < kReaderCount; ++id)
+            {
+                readers.emplace_back(check_reader, id);
+            }
+
+            check_batch();
+            batch_done = true;
+
+            for (auto& t : readers)
+            {
+                t.join();
+            }
+        }
+
+        output << "{\n";
+        output << "    \"documents\": " << kDocumentCount << ",\n";
+        output << "    \"rounds\": " << options.iterations << ",\n";
+        output << "    \"mismatches\": " << mismatch_count << "\n";
+        output << "}\n";
+
+        return mismatch_count == 0;
+    }
+}
@@ -0,0 +1,42 @@
+#include "benchmark.h"
+#include "lang.h"
+
+using namespace std;
+
+namespace eds::loli::bench
+{
+    // a translation unit of functions covering declarations, expressions and all kinds of statements
+    string GenerateLangInput(int size)
+    {
+        string result;
+        for (int i = 0; result.length() < size; ++i)
+        {
+            auto name = "f" + to_string(i);
+
+            result.append("func " + name + "(x: int, y: int, flag: bool) -> int\n");
+            result.append("{\n");
+            result.append("    val z: int = x * 41 + y / 3 - (x & y);\n");
+            result.append("    var acc: int = 0;\n");
+            result.append("    while (acc < z && flag) { val step: int = acc + " + to_string(i % 7 + 1) + "; if (step > 100) break; else continue; }\n");
+            result.append("    if (x == y || false) { return y % 7; } else return x;\n");
+            result.append("    return acc;\n");
+            result.append("}\n");
+        }
+
+        return result;
+    }
+
+    GrammarReport RunLangBenchmark(const BenchmarkOptions& options)
+    {
+        auto report = GrammarReport{"lang"};
+        auto config = LoadTextFile(options.grammar_dir + "/lang.loli.txt");
+        MeasureConstruction(report, config, options);
+
+        auto parser      = lang::CreateParser(options.table_budget);
+        report.footprint = parser->Footprint();
+
+        MeasureParsing(report, *parser, GenerateInput(config, options, GenerateLangInput), options);
+
+        return report;
+    }
+}
@@ -0,0 +1,25 @@
+#include "benchmark.h"
+
+using namespace std;
+
+namespace eds::loli::bench
+{
+    vector<ScalingReport> RunScalingBenchmark(const BenchmarkOptions& options)
+    {
+        auto result = vector<ScalingReport>{};
+
+        auto shape = options.shape;
+        for (int i = 0; i < options.scaling_steps; ++i)
+        {
+            auto report = GrammarReport{"synthetic-" + to_string(i)};
+            MeasureConstruction(report, GenerateGrammarConfig(shape), options);
+
+            result.push_back(ScalingReport{shape, report});
+
+            shape.token_count *= 2;
+            shape.rule_count *= 2;
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,256 @@
+#include "benchmark.h"
+#include "lexing/lexing-automaton.h"
+#include "parsing/parsing-automaton.h"
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <stdexcept>
+
+using namespace std;
+
+// =====================================================================================
+// Heap Accounting
+//
+
+namespace
+{
+    atomic<size_t> allocated_heap_bytes{0};
+}
+
+void* operator new(size_t size)
+{
+    allocated_heap_bytes.fetch_add(size, memory_order_relaxed);
+
+    if (auto p = malloc(size > 0 ? size : 1); p)
+        return p;
+
+    throw bad_alloc{};
+}
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+namespace eds::loli::bench
+{
+    size_t AllocatedHeapBytes()
+    {
+        return allocated_heap_bytes.load(memory_order_relaxed);
+    }
+
+    // =====================================================================================
+    // Implementation of Measurements
+    //
+
+    string LoadTextFile(const string& path)
+    {
+        ifstream file{path};
+        if (!file)
+            throw runtime_error{"Benchmark: failed to open " + path};
+
+        return string(istreambuf_iterator<char>{file}, {});
+    }
+
+    string GenerateInput(const string& config, const BenchmarkOptions& options, string (*fallback)(int))
+    {
+        if (!options.random_inputs)
+            return fallback(options.input_size);
+
+        auto info = ResolveParsingInfo(config, nullptr);
+
+        auto generator_options = SentenceGenerator::Options{};
+        generator_options.seed = options.seed;
+
+        auto result = string{};
+        SentenceGenerator{*info, generator_options}.Generate(result, options.input_size);
+
+        return result;
+    }
+
+    void MeasureConstruction(GrammarReport& report, const string& config, const BenchmarkOptions& options)
+    {
+        // NOTE no proxy manager is needed as nothing is parsed
+        // NOTE heap bytes are those of the last run, which are the same for each run
+        unique_ptr<ParsingMetaInfo> info;
+        auto resolving_time = MeasureBest(options.iterations, [&]() {
+            auto allocated = AllocatedHeapBytes();
+            info           = ResolveParsingInfo(config, nullptr);
+
+            report.resolve_parsing_info_bytes = AllocatedHeapBytes() - allocated;
+        });
+
+        unique_ptr<const lexing::LexingAutomaton> dfa;
+        auto lexing_time = MeasureBest(options.iterations, [&]() {
+            auto allocated = AllocatedHeapBytes();
+            dfa            = lexing::BuildLexingAutomaton(*info);
+
+            report.build_lexing_automaton_bytes = AllocatedHeapBytes() - allocated;
+        });
+
+        unique_ptr<const parsing::ParsingAutomaton> pda;
+        auto parsing_time = MeasureBest(options.iterations, [&]() {
+            auto allocated = AllocatedHeapBytes();
+            pda            = parsing::BuildLALRAutomaton(*info);
+
+            report.build_lalr_automaton_bytes = AllocatedHeapBytes() - allocated;
+        });
+
+        report.resolve_parsing_info_ms   = resolving_time * 1000;
+        report.build_lexing_automaton_ms = lexing_time * 1000;
+        report.build_lalr_automaton_ms   = parsing_time * 1000;
+
+        report.grammar_token_count      = info->Tokens().Size();
+        report.grammar_variable_count   = info->Variables().Size();
+        report.grammar_production_count = info->Productions().Size();
+
+        report.lexing_state_count  = dfa->StateCount();
+        report.parsing_state_count = pda->StateCount();
+    }
+
+    ScalingExponents EstimateScalingExponents(const vector<ScalingReport>& reports)
+    {
+        auto result = ScalingExponents{};
+        if (reports.size() < 2)
+            return result;
+
+        const auto& first = reports[reports.size() - 2].report;
+        const auto& last  = reports.back().report;
+
+        auto exponent = [&](double first_ms, double last_ms) {
+            if (first_ms <= 0 || last_ms <= 0 || last.grammar_production_count == first.grammar_production_count)
+                return 0.;
+
+            return log(last_ms / first_ms) / log(static_cast<double>(last.grammar_production_count) / first.grammar_production_count);
+        };
+
+        result.resolve_parsing_info   = exponent(first.resolve_parsing_info_ms, last.resolve_parsing_info_ms);
+        result.build_lexing_automaton = exponent(first.build_lexing_automaton_ms, last.build_lexing_automaton_ms);
+        result.build_lalr_automaton   = exponent(first.build_lalr_automaton_ms, last.build_lalr_automaton_ms);
+
+        return result;
+    }
+
+    // =====================================================================================
+    // Implementation of Reports
+    //
+
+    namespace
+    {
+        void WriteConstruction(ostream& output, const GrammarReport& report, const string& indent)
+        {
+            output << indent << "\"construction\": {\n";
+            output << indent << "    \"resolve_parsing_info_ms\": " << report.resolve_parsing_info_ms << ",\n";
+            output << indent << "    \"build_lexing_automaton_ms\": " << report.build_lexing_automaton_ms << ",\n";
+            output << indent << "    \"build_lalr_automaton_ms\": " << report.build_lalr_automaton_ms << ",\n";
+            output << indent << "    \"resolve_parsing_info_bytes\": " << report.resolve_parsing_info_bytes << ",\n";
+            output << indent << "    \"build_lexing_automaton_bytes\": " << report.build_lexing_automaton_bytes << ",\n";
+            output << indent << "    \"build_lalr_automaton_bytes\": " << report.build_lalr_automaton_bytes << ",\n";
+            output << indent << "    \"grammar_token_count\": " << report.grammar_token_count << ",\n";
+            output << indent << "    \"grammar_variable_count\": " << report.grammar_variable_count << ",\n";
+            output << indent << "    \"grammar_production_count\": " << report.grammar_production_count << ",\n";
+            output << indent << "    \"lexing_state_count\": " << report.lexing_state_count << ",\n";
+            output << indent << "    \"parsing_state_count\": " << report.parsing_state_count << "\n";
+            output << indent << "}";
+        }
+
+        void WriteFootprint(ostream& output, const TableFootprint& footprint, const string& indent)
+        {
+            auto encoding = footprint.encoding == TableEncoding::Dense ? "dense" : "compact";
+
+            output << indent << "\"tables\": {\n";
+            output << indent << "    \"encoding\": \"" << encoding << "\",\n";
+            output << indent << "    \"lexing_table_bytes\": " << footprint.lexing_table_bytes << ",\n";
+            output << indent << "    \"acc_token_lookup_bytes\": " << footprint.acc_token_lookup_bytes << ",\n";
+            output << indent << "    \"action_table_bytes\": " << footprint.action_table_bytes << ",\n";
+            output << indent << "    \"eof_action_table_bytes\": " << footprint.eof_action_table_bytes << ",\n";
+            output << indent << "    \"goto_table_bytes\": " << footprint.goto_table_bytes << ",\n";
+            output << indent << "    \"auxiliary_bytes\": " << footprint.auxiliary_bytes << ",\n";
+            output << indent << "    \"table_bytes\": " << footprint.TableBytes() << ",\n";
+            output << indent << "    \"meta_info_bytes\": " << footprint.meta_info_bytes << "\n";
+            output << indent << "}";
+        }
+    }
+
+    void WriteReport(ostream& output, const BenchmarkOptions& options, const vector<GrammarReport>& reports)
+    {
+        output << fixed << setprecision(3);
+
+        output << "{\n";
+        output << "    \"input_size\": " << options.input_size << ",\n";
+        output << "    \"iterations\": " << options.iterations << ",\n";
+        output << "    \"random_inputs\": " << (options.random_inputs ? "true" : "false") << ",\n";
+        output << "    \"seed\": " << options.seed << ",\n";
+        output << "    \"table_budget\": " << options.table_budget << ",\n";
+        output << "    \"grammars\": [";
+
+        for (int i = 0; i < reports.size(); ++i)
+        {
+            const auto& report = reports[i];
+
+            output << (i > 0 ? ",\n" : "\n");
+            output << "        {\n";
+            output << "            \"name\": \"" << report.name << "\",\n";
+            WriteConstruction(output, report, "            ");
+            output << ",\n";
+            output << "            \"input\": {\n";
+            output << "                \"bytes\": " << report.input_bytes << ",\n";
+            output << "                \"tokens\": " << report.token_count << ",\n";
+            output << "                \"reductions\": " << report.reduction_count << "\n";
+            output << "            },\n";
+            WriteFootprint(output, report.footprint, "            ");
+            output << ",\n";
+            output << "            \"lexer_mb_per_s\": " << report.lexer_mb_per_s << ",\n";
+            output << "            \"parser_tokens_per_s\": " << report.parser_tokens_per_s << ",\n";
+            output << "            \"reductions_per_s\": " << report.reductions_per_s << ",\n";
+            output << "            \"heap_bytes_per_input_byte\": " << report.heap_bytes_per_input_byte << "\n";
+            output << "        }";
+        }
+
+        output << "\n    ]\n";
+        output << "}\n";
+    }
+
+    void WriteScalingReport(ostream& output, const BenchmarkOptions& options, const vector<ScalingReport>& reports)
+    {
+        const auto exponents = EstimateScalingExponents(reports);
+
+        output << fixed << setprecision(3);
+
+        output << "{\n";
+        output << "    \"iterations\": " << options.iterations << ",\n";
+        output << "    \"exponents\": {\n";
+        output << "        \"resolve_parsing_info\": " << exponents.resolve_parsing_info << ",\n";
+        output << "        \"build_lexing_automaton\": " << exponents.build_lexing_automaton << ",\n";
+        output << "        \"build_lalr_automaton\": " << exponents.build_lalr_automaton << "\n";
+        output << "    },\n";
+        output << "    \"grammars\": [";
+
+        for (int i = 0; i < reports.size(); ++i)
+        {
+            const auto& shape = reports[i].shape;
+
+            output << (i > 0 ? ",\n" : "\n");
+            output << "        {\n";
+            output << "            \"shape\": {\n";
+            output << "                \"token_count\": " << shape.token_count << ",\n";
+            output << "                \"rule_count\": " << shape.rule_count << ",\n";
+            output << "                \"nesting\": " << shape.nesting << ",\n";
+            output << "                \"operator_layers\": " << shape.operator_layers << ",\n";
+            output << "                \"list_rules\": " << shape.list_rules << "\n";
+            output << "            },\n";
+            WriteConstruction(output, reports[i].report, "            ");
+            output << "\n";
+            output << "        }";
+        }
+
+        output << "\n    ]\n";
+        output << "}\n";
+    }
+}
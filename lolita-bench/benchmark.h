@@ -0,0 +1,220 @@
+#pragma once
+#include "parser.h"
+#include "grammar-generator.h"
+#include "core/sentence-generator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace eds::loli::bench
+{
+    // =====================================================================================
+    // Options & Reports
+    //
+
+    struct BenchmarkOptions
+    {
+        // minimum length of generated inputs in bytes
+        int input_size = 1 << 20;
+
+        // each measurement takes the best of these runs
+        int iterations = 5;
+
+        // directory of calc.loli.txt and lang.loli.txt, which are resolved for construction timings
+        std::string grammar_dir = "";
+
+        // inputs are random sentences of each grammar instead of handwritten patterns, see SentenceGenerator
+        bool random_inputs = false;
+        uint64_t seed      = 0;
+
+        // parsers of grammars are created with this budget of tables, see GenericParser::GenericParser
+        size_t table_budget = 0;
+
+        // synthetic grammar of the first step of scaling, which doubles tokens and rules each further step
+        GrammarShape shape = {};
+        int scaling_steps  = 5;
+    };
+
+    struct GrammarReport
+    {
+        std::string name;
+
+        // construction in milliseconds, see ResolveParsingInfo, BuildLexingAutomaton and BuildLALRAutomaton
+        double resolve_parsing_info_ms   = 0;
+        double build_lexing_automaton_ms = 0;
+        double build_lalr_automaton_ms   = 0;
+
+        // heap bytes requested by each step of construction
+        size_t resolve_parsing_info_bytes   = 0;
+        size_t build_lexing_automaton_bytes = 0;
+        size_t build_lalr_automaton_bytes   = 0;
+
+        int grammar_token_count      = 0;
+        int grammar_variable_count   = 0;
+        int grammar_production_count = 0;
+
+        int lexing_state_count  = 0;
+        int parsing_state_count = 0;
+
+        // tables of the parser measured
+        TableFootprint footprint = {};
+
+        // generated input
+        int input_bytes     = 0;
+        int token_count     = 0;
+        int reduction_count = 0;
+
+        // tokenizing only
+        double lexer_mb_per_s = 0;
+
+        // recognizing only, i.e. no AST is constructed
+        double parser_tokens_per_s = 0;
+
+        // parsing into AST
+        double reductions_per_s = 0;
+
+        // heap memory requested while parsing into a fresh arena, which covers arena blocks,
+        // vectors in AST and stacks of the parser
+        // NOTE it's counted by global operator new, see AllocatedHeapBytes, rather than bytes used in the arena
+        double heap_bytes_per_input_byte = 0;
+    };
+
+    // construction of a synthetic grammar, where no input is parsed
+    struct ScalingReport
+    {
+        GrammarShape shape;
+        GrammarReport report;
+    };
+
+    // how fast a step of construction grows with grammar size, i.e. the exponent k in time ~ productions^k
+    // between the last two synthetic grammars, which is close to 1 for a linear builder
+    struct ScalingExponents
+    {
+        double resolve_parsing_info   = 0;
+        double build_lexing_automaton = 0;
+        double build_lalr_automaton   = 0;
+    };
+
+    ScalingExponents EstimateScalingExponents(const std::vector<ScalingReport>& reports);
+
+    // write reports as a JSON object
+    void WriteReport(std::ostream& output, const BenchmarkOptions& options, const std::vector<GrammarReport>& reports);
+    void WriteScalingReport(std::ostream& output, const BenchmarkOptions& options, const std::vector<ScalingReport>& reports);
+
+    // =====================================================================================
+    // Measurements
+    //
+
+    std::string LoadTextFile(const std::string& path);
+
+    // a random sentence of the root variable of config, or fallback if random inputs are not enabled
+    // NOTE config is resolved again as regex trees of tokens are released by parsers
+    std::string GenerateInput(const std::string& config, const BenchmarkOptions& options, std::string (*fallback)(int));
+
+    // total bytes requested via global operator new so far
+    size_t AllocatedHeapBytes();
+
+    // best time of callback in seconds
+    template <typename F>
+    double MeasureBest(int iterations, F callback)
+    {
+        auto best = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            callback();
+            auto stop = std::chrono::steady_clock::now();
+
+            best = std::min(best, std::chrono::duration<double>(stop - start).count());
+        }
+
+        return best;
+    }
+
+    void MeasureConstruction(GrammarReport& report, const std::string& config, const BenchmarkOptions& options);
+
+    template <typename T>
+    void MeasureParsing(GrammarReport& report, const BasicParser<T>& parser, const std::string& input, const BenchmarkOptions& options)
+    {
+        struct ReductionCounter final
+        {
+            int count = 0;
+
+            void OnShift(const ast::BasicAstToken& tok) {}
+            void OnReduce(const ProductionInfo& production, ast::AstLocationInfo span, ArrayRef<ast::AstLocationInfo> children)
+            {
+                ++count;
+            }
+            void OnAccept() {}
+            void OnError(int offset) {}
+        };
+
+        // count tokens and reductions, which also validates the input
+        auto tokens  = TokenBuffer{input};
+        auto counter = ReductionCounter{};
+        if (!parser.Tokenize(tokens).accepted || !parser.ParseEvents(input, counter).accepted)
+            throw ParserInternalError{"Benchmark: generated input is rejected"};
+
+        report.input_bytes     = input.length();
+        report.token_count     = tokens.Size();
+        report.reduction_count = counter.count;
+
+        // lexer, where the buffer is tokenized from scratch each time
+        auto lexing_time = MeasureBest(options.iterations, [&]() {
+            parser.Tokenize(tokens);
+        });
+
+        report.lexer_mb_per_s = input.length() / lexing_time / (1 << 20);
+
+        // recognizer
+        auto recognizing_time = MeasureBest(options.iterations, [&]() {
+            parser.Validate(input);
+        });
+
+        report.parser_tokens_per_s = report.token_count / recognizing_time;
+
+        // AST
+        auto parsing_time = MeasureBest(options.iterations, [&]() {
+            Arena arena;
+            parser.Parse(arena, input);
+        });
+
+        report.reductions_per_s = report.reduction_count / parsing_time;
+
+        // memory
+        {
+            auto allocated = AllocatedHeapBytes();
+
+            Arena arena;
+            parser.Parse(arena, input);
+
+            report.heap_bytes_per_input_byte = static_cast<double>(AllocatedHeapBytes() - allocated) / input.length();
+        }
+    }
+
+    // =====================================================================================
+    // Grammars
+    //
+
+    // handwritten inputs of at least size bytes
+    std::string GenerateLangInput(int size);
+
+    GrammarReport RunCalcBenchmark(const BenchmarkOptions& options);
+    GrammarReport RunLangBenchmark(const BenchmarkOptions& options);
+
+    // construction of synthetic grammars growing from options.shape, see GenerateGrammarConfig
+    std::vector<ScalingReport> RunScalingBenchmark(const BenchmarkOptions& options);
+
+    // =====================================================================================
+    // Checks
+    //
+
+    // parse documents of lang with ParseBatch while other threads run TryParse and ParseEvents on the same parser,
+    // and compare each result with a serial parse, returns false on any mismatch
+    // NOTE options.iterations is the number of rounds, and options.input_size is split among documents
+    bool RunConcurrencyCheck(const BenchmarkOptions& options, std::ostream& output);
+}
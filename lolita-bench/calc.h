@@ -0,0 +1,300 @@
+// THIS FILE IS GENERATED BY PROJ. LOLITA.
+// PLEASE DO NOT MODIFY!!!
+//
+
+#pragma once
+#include "lolita-include.h"
+
+namespace eds::loli::calc
+{
+    // Referred Names
+    //
+    using eds::loli::BasicParser;
+    using eds::loli::ast::AstOptional;
+    using eds::loli::ast::AstTypeProxyManager;
+    using eds::loli::ast::AstVector;
+    using eds::loli::ast::BasicAstEnum;
+    using eds::loli::ast::BasicAstObject;
+    using eds::loli::ast::BasicAstToken;
+    using eds::loli::ast::BasicAstTypeProxy;
+    using eds::loli::ast::DataBundle;
+
+    // Forward declarations
+    //
+
+    class Expression;
+
+    class LiteralExpression;
+    class BinaryExpression;
+
+    // Enum definitions
+    //
+
+    enum BinaryOp
+    {
+        Plus,
+        Minus,
+        Asterisk,
+        Slash,
+    };
+
+    // Base definitions
+    //
+
+    class Expression : public BasicAstObject
+    {
+    public:
+        enum class Kind
+        {
+            LiteralExpression,
+            BinaryExpression,
+        };
+
+        struct Visitor
+        {
+            virtual void Visit(LiteralExpression&) = 0;
+            virtual void Visit(BinaryExpression&)  = 0;
+        };
+
+        Expression(Kind kind) : kind_(kind) {}
+
+        Kind GetKind() const { return kind_; }
+
+        virtual void Accept(Visitor&) = 0;
+
+        template <typename F>
+        decltype(auto) Visit(F&& f);
+
+    private:
+        Kind kind_;
+    };
+
+    // Class definitions
+    //
+
+    class LiteralExpression : public Expression, public DataBundle<BasicAstToken>
+    {
+    public:
+        LiteralExpression() : Expression(Kind::LiteralExpression) {}
+
+        const auto& value() const { return GetItem<0>(); }
+
+        void Accept(Expression::Visitor& v) override { v.Visit(*this); }
+    };
+    class BinaryExpression : public Expression, public DataBundle<Expression*, BasicAstEnum<BinaryOp>, Expression*>
+    {
+    public:
+        BinaryExpression() : Expression(Kind::BinaryExpression) {}
+
+        const auto& lhs() const { return GetItem<0>(); }
+        const auto& op() const { return GetItem<1>(); }
+        const auto& rhs() const { return GetItem<2>(); }
+
+        void Accept(Expression::Visitor& v) override { v.Visit(*this); }
+    };
+
+    // Static dispatch
+    //
+
+    template <typename F>
+    inline decltype(auto) Expression::Visit(F&& f)
+    {
+        switch (kind_)
+        {
+        case Kind::LiteralExpression:
+            return std::forward<F>(f)(static_cast<LiteralExpression&>(*this));
+        case Kind::BinaryExpression:
+            return std::forward<F>(f)(static_cast<BinaryExpression&>(*this));
+        default:
+            throw ParserInternalError{"Expression: invalid node kind"};
+        }
+    }
+
+    // Environment
+    //
+
+    inline BasicParser<Expression>::Ptr CreateParser(size_t table_budget = 0)
+    {
+        static const auto config =
+            u8R"##########(
+ignore whitespace = "[ \t\r\n]+";
+token int = "[0-9]+";
+token op_add = "\+";
+token op_minus = "-";
+token op_asterisk = "\*";
+token op_slash = "/";
+token lp = "\(";
+token rp = "\)";
+token comma = ",";
+
+enum BinaryOp { Plus; Minus; Asterisk; Slash; }
+
+base Expression;
+
+node LiteralExpression : Expression
+{
+    token value;
+}
+
+node BinaryExpression : Expression
+{
+    Expression lhs;
+    BinaryOp op;
+    Expression rhs;
+}
+
+rule AddOp : BinaryOp
+    = op_add -> Plus
+    = op_minus -> Minus
+    ;
+rule MulOp : BinaryOp
+    = op_asterisk -> Asterisk
+    = op_slash -> Slash
+    ;
+
+rule Factor : Expression
+    = int:value -> LiteralExpression @Literal
+    = lp Expr! rp
+    ;
+rule MulExpr : Expression
+    = MulExpr:lhs MulOp:op Factor:rhs -> BinaryExpression @Binary
+    = Factor!
+    ;
+rule AddExpr : Expression
+    = AddExpr:lhs AddOp:op MulExpr:rhs -> BinaryExpression @Binary
+    = MulExpr!
+    ;
+
+rule Expr : Expression
+    = AddExpr!
+    ;
+)##########";
+        static const auto proxy_manager = []() {
+            AstTypeProxyManager env;
+
+            // register enums
+            env.RegisterEnum<BinaryOp>("BinaryOp");
+
+            // register bases
+            env.RegisterKlass<Expression>("Expression");
+
+            // register classes
+            env.RegisterKlass<LiteralExpression>("LiteralExpression");
+            env.RegisterKlass<BinaryExpression>("BinaryExpression");
+
+            return env;
+        }();
+
+        return BasicParser<Expression>::Create(config, &proxy_manager, table_budget);
+    }
+
+    // Semantic actions
+    //
+
+    // Folds values with Actions as parsing goes instead of constructing AST, where Actions provides
+    // - a value type named after each variable type, e.g. `using Expression = int;`
+    // - methods bound in rules with `@`, which take values of right-hand side in order,
+    //   where a token is passed as its text in data, i.e. std::string_view
+    // NOTE a production without action forwards its selected item or yields its enum hint,
+    //      and a production that does neither must bind an action, see BootstrapParser
+    template <typename Actions>
+    class SemanticActionHandler final
+    {
+    public:
+        using ValueType  = std::variant<BasicAstToken, typename Actions::BinaryOp, typename Actions::Expression>;
+        using ResultType = typename Actions::Expression;
+
+        SemanticActionHandler(Actions& actions, std::string_view data) : actions_(actions), data_(data) {}
+
+        void OnShift(const BasicAstToken& tok)
+        {
+            stack_.emplace_back(std::in_place_index<0>, tok);
+        }
+        void OnReduce(const ProductionInfo& production, ast::AstLocationInfo span, ArrayRef<ast::AstLocationInfo> children)
+        {
+            const auto base = stack_.size() - children.Length();
+            switch (production.Id())
+            {
+            case 0: // AddOp
+                Fold<1>(base, BinaryOp::Plus);
+                break;
+            case 1: // AddOp
+                Fold<1>(base, BinaryOp::Minus);
+                break;
+            case 2: // MulOp
+                Fold<1>(base, BinaryOp::Asterisk);
+                break;
+            case 3: // MulOp
+                Fold<1>(base, BinaryOp::Slash);
+                break;
+            case 4: // Factor
+                Fold<2>(base, actions_.Literal(TakeText(base + 0)));
+                break;
+            case 5: // Factor
+                Fold<2>(base, Take<2>(base + 1));
+                break;
+            case 6: // MulExpr
+                Fold<2>(base, actions_.Binary(Take<2>(base + 0), Take<1>(base + 1), Take<2>(base + 2)));
+                break;
+            case 7: // MulExpr
+                Fold<2>(base, Take<2>(base + 0));
+                break;
+            case 8: // AddExpr
+                Fold<2>(base, actions_.Binary(Take<2>(base + 0), Take<1>(base + 1), Take<2>(base + 2)));
+                break;
+            case 9: // AddExpr
+                Fold<2>(base, Take<2>(base + 0));
+                break;
+            case 10: // Expr
+                Fold<2>(base, Take<2>(base + 0));
+                break;
+            default:
+                throw ParserInternalError{"SemanticActionHandler: invalid production"};
+            }
+        }
+        void OnAccept() {}
+        void OnError(int offset) {}
+
+        ResultType Finalize()
+        {
+            assert(stack_.size() == 1);
+            return Take<2>(0);
+        }
+
+    private:
+        template <size_t I>
+        decltype(auto) Take(size_t index)
+        {
+            return std::move(std::get<I>(stack_[index]));
+        }
+        std::string_view TakeText(size_t index)
+        {
+            const auto& tok = std::get<0>(stack_[index]);
+            return data_.substr(tok.Offset(), tok.Length());
+        }
+
+        // NOTE value is constructed before its children are popped
+        template <size_t I, typename... Args>
+        void Fold(size_t base, Args&&... args)
+        {
+            auto value = std::variant_alternative_t<I, ValueType>(std::forward<Args>(args)...);
+            stack_.erase(stack_.begin() + base, stack_.end());
+            stack_.emplace_back(std::in_place_index<I>, std::move(value));
+        }
+
+        Actions& actions_;
+        std::string_view data_;
+        std::vector<ValueType> stack_ = {};
+    };
+
+    // parse data and fold it with actions, returns value of the root variable
+    template <typename Actions>
+    inline typename Actions::Expression Evaluate(BasicParser<Expression>& parser, std::string_view data, Actions& actions)
+    {
+        SemanticActionHandler<Actions> handler{actions, data};
+        if (!parser.ParseEvents(data, handler).accepted)
+            throw ParserInternalError{"parsing error"};
+
+        return handler.Finalize();
+    }
+}
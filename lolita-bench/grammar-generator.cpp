@@ -0,0 +1,186 @@
+#include "grammar-generator.h"
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+namespace eds::loli::bench
+{
+    namespace
+    {
+        string Suffixed(const string& name, int index)
+        {
+            return name + to_string(index);
+        }
+
+        // keywords leading the index-th statement of a level, which are unique within the level
+        string KeywordPrefix(int index, int keyword_count)
+        {
+            // bijective numeration in base keyword_count
+            string result;
+            for (int n = index; n >= 0; n = n / keyword_count - 1)
+            {
+                result.append(Suffixed("kw", n % keyword_count));
+                result.append(result.find(' ') == string::npos ? ":head " : " ");
+            }
+
+            return result;
+        }
+    }
+
+    string GenerateGrammarConfig(const GrammarShape& shape)
+    {
+        const auto nesting         = max(shape.nesting, 1);
+        const auto operator_layers = max(shape.operator_layers, 1);
+        const auto list_rules      = max(shape.list_rules, 0);
+
+        // tokens
+        const auto free_tokens    = max(shape.token_count - 8, operator_layers + 1);
+        const auto operator_count = max(operator_layers, free_tokens / 3);
+        const auto keyword_count  = free_tokens - operator_count;
+
+        // rules, where statements fill up what the skeleton leaves
+        const auto skeleton_rules  = 3 + operator_layers + 2 * nesting + (nesting - 1) + list_rules;
+        const auto statement_count = max(shape.rule_count - skeleton_rules, nesting);
+
+        string result;
+        auto line = [&](const string& text) {
+            result.append(text);
+            result.push_back('\n');
+        };
+
+        line("# generated with token_count=" + to_string(shape.token_count) +
+             " rule_count=" + to_string(shape.rule_count) +
+             " nesting=" + to_string(nesting) +
+             " operator_layers=" + to_string(operator_layers) +
+             " list_rules=" + to_string(list_rules));
+        line("");
+
+        // =====================================================================================
+        // Tokens
+        //
+
+        line("ignore whitespace = \"[ \\t\\r\\n]+\";");
+        line("token id = \"[_a-z]+\";");
+        line("token num = \"[0-9]+\";");
+        line("token lp = \"\\(\";");
+        line("token rp = \"\\)\";");
+        line("token lb = \"{\";");
+        line("token rb = \"}\";");
+        line("token semi = \";\";");
+        line("token comma = \",\";");
+
+        for (int i = 0; i < operator_count; ++i)
+            line("token " + Suffixed("op", i) + " = \"~" + to_string(i) + "\";");
+
+        // NOTE keywords contain digits so that they never match id
+        for (int i = 0; i < keyword_count; ++i)
+            line("token " + Suffixed("kw", i) + " = \"" + Suffixed("k", i) + "\";");
+
+        line("");
+
+        // =====================================================================================
+        // Types
+        //
+
+        line("base Node;");
+        line("node Leaf : Node { token value; }");
+        line("node Binary : Node { Node lhs; token op; Node rhs; }");
+        line("node Simple : Node { token head; Node value; }");
+        line("node Construct : Node { token head; Node'vec children; }");
+        line("node Unit { Node'vec children; }");
+        line("");
+
+        // =====================================================================================
+        // Expressions
+        //
+
+        line("rule Atom : Node");
+        line("    = id:value -> Leaf");
+        line("    = num:value -> Leaf");
+        line("    = lp Expr! rp");
+        line("    ;");
+
+        for (int layer = operator_layers - 1; layer >= 0; --layer)
+        {
+            const auto name = Suffixed("OpLayer", layer);
+            const auto next = layer + 1 < operator_layers ? Suffixed("OpLayer", layer + 1) : string{"Atom"};
+
+            line("rule " + name + " : Node");
+            for (int i = layer; i < operator_count; i += operator_layers)
+                line("    = " + name + ":lhs " + Suffixed("op", i) + ":op " + next + ":rhs -> Binary");
+
+            line("    = " + next + "!");
+            line("    ;");
+        }
+
+        line("rule Expr : Node");
+        line("    = OpLayer0!");
+        line("    ;");
+
+        for (int i = 0; i < list_rules; ++i)
+        {
+            const auto name = Suffixed("ArgList", i);
+
+            line("rule " + name + " : Node'vec");
+            line("    = Expr& -> _");
+            line("    = " + name + "! comma Expr&");
+            line("    ;");
+        }
+
+        line("");
+
+        // =====================================================================================
+        // Statements
+        //
+
+        // innermost level first, so that each level refers to a defined one
+        for (int level = nesting - 1; level >= 0; --level)
+        {
+            const auto name  = Suffixed("Level", level);
+            const auto count = statement_count / nesting + (level < statement_count % nesting ? 1 : 0);
+
+            for (int i = 0; i < count; ++i)
+            {
+                const auto prefix = KeywordPrefix(i, keyword_count);
+
+                line("rule " + name + "Stmt" + to_string(i) + " : Node");
+                if (level + 1 < nesting)
+                    line("    = " + prefix + name + "Block:children -> Construct");
+                else if (list_rules > 0 && i % 2 == 1)
+                    line("    = " + prefix + "lp " + Suffixed("ArgList", i / 2 % list_rules) + ":children rp semi -> Construct");
+                else
+                    line("    = " + prefix + "Expr:value semi -> Simple");
+                line("    ;");
+            }
+
+            line("rule " + name + "Stmt : Node");
+            for (int i = 0; i < count; ++i)
+                line("    = " + name + "Stmt" + to_string(i) + "!");
+            line("    ;");
+
+            line("rule " + name + "List : Node'vec");
+            line("    = " + name + "Stmt& -> _");
+            line("    = " + name + "List! " + name + "Stmt&");
+            line("    ;");
+
+            if (level > 0)
+            {
+                const auto outer = Suffixed("Level", level - 1);
+
+                line("rule " + outer + "Block : Node'vec");
+                line("    = lb rb -> _");
+                line("    = lb " + name + "List! rb");
+                line("    ;");
+            }
+
+            line("");
+        }
+
+        line("rule Program : Unit");
+        line("    = Level0List:children -> _");
+        line("    ;");
+
+        return result;
+    }
+}
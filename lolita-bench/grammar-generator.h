@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+
+namespace eds::loli::bench
+{
+    // =====================================================================================
+    // Synthetic Grammars
+    //
+
+    // Parameters of a synthetic grammar, which is conflict-free LALR(1) for any shape
+    //
+    // The grammar is a list of statements, where a statement of a nesting level other than the innermost
+    // takes a braced list of statements of the next level, and a statement of the innermost level
+    // takes an expression or an argument list. Expressions are chains of binary operators in layers
+    // of precedence. Statements are told apart by a prefix of keywords.
+    struct GrammarShape
+    {
+        // total tokens, no less than 8 punctuations and identifiers plus an operator per layer and a keyword
+        int token_count = 32;
+
+        // total rules, where those beyond the skeleton are statements spread across nesting levels
+        int rule_count = 64;
+
+        // levels of statements nested in braces
+        int nesting = 3;
+
+        // precedence layers of binary expressions
+        int operator_layers = 4;
+
+        // comma-separated argument lists, besides a statement list per nesting level
+        int list_rules = 2;
+    };
+
+    // text of a .loli config of shape
+    std::string GenerateGrammarConfig(const GrammarShape& shape);
+}
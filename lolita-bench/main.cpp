@@ -0,0 +1,154 @@
+#include "benchmark.h"
+#include "core/trace.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+using namespace eds::loli::bench;
+
+#ifndef LOLITA_GRAMMAR_DIR
+#define LOLITA_GRAMMAR_DIR "."
+#endif
+
+void PrintUsage()
+{
+    cerr << "usage: lolita-bench [--mode grammars|scaling|emit-grammar|concurrency] [--iterations n] [--output file] [--trace file]\n"
+         << "  grammars:     [--size bytes] [--grammar-dir path] [--random seed] [--table-budget bytes]\n"
+         << "  concurrency:  same as grammars\n"
+         << "  scaling:      [--steps n] [--max-exponent k] and shape options\n"
+         << "  emit-grammar: shape options\n"
+         << "shape options: [--tokens n] [--rules n] [--nesting n] [--layers n] [--lists n]\n";
+}
+
+int main(int argc, char** argv)
+{
+    auto options     = BenchmarkOptions{};
+    auto output_path = string{};
+    auto trace_path  = string{};
+    auto mode        = string{"grammars"};
+
+    // scaling fails if a step of construction grows faster than this, zero to disable
+    auto max_exponent = 0.;
+
+    options.grammar_dir = LOLITA_GRAMMAR_DIR;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (i + 1 == argc)
+        {
+            PrintUsage();
+            return 1;
+        }
+
+        if (strcmp(argv[i], "--mode") == 0)
+            mode = argv[++i];
+        else if (strcmp(argv[i], "--size") == 0)
+            options.input_size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--iterations") == 0)
+            options.iterations = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--grammar-dir") == 0)
+            options.grammar_dir = argv[++i];
+        else if (strcmp(argv[i], "--random") == 0)
+        {
+            options.random_inputs = true;
+            options.seed          = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--table-budget") == 0)
+            options.table_budget = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--tokens") == 0)
+            options.shape.token_count = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rules") == 0)
+            options.shape.rule_count = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--nesting") == 0)
+            options.shape.nesting = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--layers") == 0)
+            options.shape.operator_layers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--lists") == 0)
+            options.shape.list_rules = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--steps") == 0)
+            options.scaling_steps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--max-exponent") == 0)
+            max_exponent = atof(argv[++i]);
+        else if (strcmp(argv[i], "--output") == 0)
+            output_path = argv[++i];
+        else if (strcmp(argv[i], "--trace") == 0)
+            trace_path = argv[++i];
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (options.input_size <= 0 || options.iterations <= 0 || options.scaling_steps <= 0)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    auto file   = ofstream{};
+    auto output = &cout;
+    if (!output_path.empty())
+    {
+        file.open(output_path);
+        output = &file;
+    }
+
+    // spans of construction and parsing phases in Chrome trace event format
+    eds::loli::Tracer tracer;
+    if (!trace_path.empty())
+        eds::loli::InstallTracer(&tracer);
+
+    auto exit_code = 0;
+    if (mode == "grammars")
+    {
+        auto reports = vector<GrammarReport>{};
+        reports.push_back(RunCalcBenchmark(options));
+        reports.push_back(RunLangBenchmark(options));
+
+        WriteReport(*output, options, reports);
+    }
+    else if (mode == "scaling")
+    {
+        auto reports = RunScalingBenchmark(options);
+        WriteScalingReport(*output, options, reports);
+
+        auto exponents = EstimateScalingExponents(reports);
+        if (max_exponent > 0 && max({exponents.resolve_parsing_info,
+                                     exponents.build_lexing_automaton,
+                                     exponents.build_lalr_automaton}) > max_exponent)
+        {
+            cerr << "lolita-bench: construction grows faster than productions^" << max_exponent << "\n";
+            exit_code = 2;
+        }
+    }
+    else if (mode == "concurrency")
+    {
+        if (!RunConcurrencyCheck(options, *output))
+        {
+            cerr << "lolita-bench: concurrent parses differ from serial ones\n";
+            exit_code = 2;
+        }
+    }
+    else if (mode == "emit-grammar")
+    {
+        *output << GenerateGrammarConfig(options.shape);
+    }
+    else
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (!trace_path.empty())
+    {
+        eds::loli::InstallTracer(nullptr);
+
+        ofstream trace_file{trace_path};
+        tracer.WriteChromeTrace(trace_file);
+    }
+
+    return exit_code;
+}
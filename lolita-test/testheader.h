@@ -87,27 +87,65 @@ namespace eds::loli
     class Literal : public BasicAstObject
     {
     public:
+        enum class Kind
+        {
+            BoolLiteral,
+            IntLiteral,
+        };
+
         struct Visitor
         {
             virtual void Visit(BoolLiteral&) = 0;
             virtual void Visit(IntLiteral&)  = 0;
         };
 
+        Literal(Kind kind) : kind_(kind) {}
+
+        Kind GetKind() const { return kind_; }
+
         virtual void Accept(Visitor&) = 0;
+
+        template <typename F>
+        decltype(auto) Visit(F&& f);
+
+    private:
+        Kind kind_;
     };
     class Type : public BasicAstObject
     {
     public:
+        enum class Kind
+        {
+            NamedType,
+        };
+
         struct Visitor
         {
             virtual void Visit(NamedType&) = 0;
         };
 
+        Type(Kind kind) : kind_(kind) {}
+
+        Kind GetKind() const { return kind_; }
+
         virtual void Accept(Visitor&) = 0;
+
+        template <typename F>
+        decltype(auto) Visit(F&& f);
+
+    private:
+        Kind kind_;
     };
     class Expression : public BasicAstObject
     {
     public:
+        enum class Kind
+        {
+            BinaryExpr,
+            NamedExpr,
+            LiteralExpr,
+        };
+
         struct Visitor
         {
             virtual void Visit(BinaryExpr&)  = 0;
@@ -115,11 +153,31 @@ namespace eds::loli
             virtual void Visit(LiteralExpr&) = 0;
         };
 
+        Expression(Kind kind) : kind_(kind) {}
+
+        Kind GetKind() const { return kind_; }
+
         virtual void Accept(Visitor&) = 0;
+
+        template <typename F>
+        decltype(auto) Visit(F&& f);
+
+    private:
+        Kind kind_;
     };
     class Statement : public BasicAstObject
     {
     public:
+        enum class Kind
+        {
+            VariableDeclStmt,
+            JumpStmt,
+            ReturnStmt,
+            CompoundStmt,
+            WhileStmt,
+            ChoiceStmt,
+        };
+
         struct Visitor
         {
             virtual void Visit(VariableDeclStmt&) = 0;
@@ -130,7 +188,17 @@ namespace eds::loli
             virtual void Visit(ChoiceStmt&)       = 0;
         };
 
+        Statement(Kind kind) : kind_(kind) {}
+
+        Kind GetKind() const { return kind_; }
+
         virtual void Accept(Visitor&) = 0;
+
+        template <typename F>
+        decltype(auto) Visit(F&& f);
+
+    private:
+        Kind kind_;
     };
 
     // Class definitions
@@ -139,6 +207,8 @@ namespace eds::loli
     class BoolLiteral : public Literal, public DataBundle<BasicAstEnum<BoolValue>>
     {
     public:
+        BoolLiteral() : Literal(Kind::BoolLiteral) {}
+
         const auto& content() const { return GetItem<0>(); }
 
         void Accept(Literal::Visitor& v) override { v.Visit(*this); }
@@ -146,6 +216,8 @@ namespace eds::loli
     class IntLiteral : public Literal, public DataBundle<BasicAstToken>
     {
     public:
+        IntLiteral() : Literal(Kind::IntLiteral) {}
+
         const auto& content() const { return GetItem<0>(); }
 
         void Accept(Literal::Visitor& v) override { v.Visit(*this); }
@@ -153,6 +225,8 @@ namespace eds::loli
     class NamedType : public Type, public DataBundle<BasicAstToken>
     {
     public:
+        NamedType() : Type(Kind::NamedType) {}
+
         const auto& name() const { return GetItem<0>(); }
 
         void Accept(Type::Visitor& v) override { v.Visit(*this); }
@@ -160,6 +234,8 @@ namespace eds::loli
     class BinaryExpr : public Expression, public DataBundle<BasicAstEnum<BinaryOp>, Expression*, Expression*>
     {
     public:
+        BinaryExpr() : Expression(Kind::BinaryExpr) {}
+
         const auto& op() const { return GetItem<0>(); }
         const auto& lhs() const { return GetItem<1>(); }
         const auto& rhs() const { return GetItem<2>(); }
@@ -169,6 +245,8 @@ namespace eds::loli
     class NamedExpr : public Expression, public DataBundle<BasicAstToken>
     {
     public:
+        NamedExpr() : Expression(Kind::NamedExpr) {}
+
         const auto& id() const { return GetItem<0>(); }
 
         void Accept(Expression::Visitor& v) override { v.Visit(*this); }
@@ -176,6 +254,8 @@ namespace eds::loli
     class LiteralExpr : public Expression, public DataBundle<Literal*>
     {
     public:
+        LiteralExpr() : Expression(Kind::LiteralExpr) {}
+
         const auto& content() const { return GetItem<0>(); }
 
         void Accept(Expression::Visitor& v) override { v.Visit(*this); }
@@ -183,6 +263,8 @@ namespace eds::loli
     class VariableDeclStmt : public Statement, public DataBundle<BasicAstEnum<VariableMutability>, BasicAstToken, Type*, Expression*>
     {
     public:
+        VariableDeclStmt() : Statement(Kind::VariableDeclStmt) {}
+
         const auto& mut() const { return GetItem<0>(); }
         const auto& name() const { return GetItem<1>(); }
         const auto& type() const { return GetItem<2>(); }
@@ -193,6 +275,8 @@ namespace eds::loli
     class JumpStmt : public Statement, public DataBundle<BasicAstEnum<JumpCommand>>
     {
     public:
+        JumpStmt() : Statement(Kind::JumpStmt) {}
+
         const auto& command() const { return GetItem<0>(); }
 
         void Accept(Statement::Visitor& v) override { v.Visit(*this); }
@@ -200,6 +284,8 @@ namespace eds::loli
     class ReturnStmt : public Statement, public DataBundle<Expression*>
     {
     public:
+        ReturnStmt() : Statement(Kind::ReturnStmt) {}
+
         const auto& expr() const { return GetItem<0>(); }
 
         void Accept(Statement::Visitor& v) override { v.Visit(*this); }
@@ -207,6 +293,8 @@ namespace eds::loli
     class CompoundStmt : public Statement, public DataBundle<AstVector<Statement*>*>
     {
     public:
+        CompoundStmt() : Statement(Kind::CompoundStmt) {}
+
         const auto& children() const { return GetItem<0>(); }
 
         void Accept(Statement::Visitor& v) override { v.Visit(*this); }
@@ -214,6 +302,8 @@ namespace eds::loli
     class WhileStmt : public Statement, public DataBundle<Expression*, Statement*>
     {
     public:
+        WhileStmt() : Statement(Kind::WhileStmt) {}
+
         const auto& pred() const { return GetItem<0>(); }
         const auto& body() const { return GetItem<1>(); }
 
@@ -222,6 +312,8 @@ namespace eds::loli
     class ChoiceStmt : public Statement, public DataBundle<Expression*, Statement*, AstOptional<Statement*>>
     {
     public:
+        ChoiceStmt() : Statement(Kind::ChoiceStmt) {}
+
         const auto& pred() const { return GetItem<0>(); }
         const auto& positive() const { return GetItem<1>(); }
         const auto& negative() const { return GetItem<2>(); }
@@ -248,6 +340,70 @@ namespace eds::loli
         const auto& functions() const { return GetItem<0>(); }
     };
 
+    // Static dispatch
+    //
+
+    template <typename F>
+    inline decltype(auto) Literal::Visit(F&& f)
+    {
+        switch (kind_)
+        {
+        case Kind::BoolLiteral:
+            return std::forward<F>(f)(static_cast<BoolLiteral&>(*this));
+        case Kind::IntLiteral:
+            return std::forward<F>(f)(static_cast<IntLiteral&>(*this));
+        default:
+            throw ParserInternalError{"Literal: invalid node kind"};
+        }
+    }
+    template <typename F>
+    inline decltype(auto) Type::Visit(F&& f)
+    {
+        switch (kind_)
+        {
+        case Kind::NamedType:
+            return std::forward<F>(f)(static_cast<NamedType&>(*this));
+        default:
+            throw ParserInternalError{"Type: invalid node kind"};
+        }
+    }
+    template <typename F>
+    inline decltype(auto) Expression::Visit(F&& f)
+    {
+        switch (kind_)
+        {
+        case Kind::BinaryExpr:
+            return std::forward<F>(f)(static_cast<BinaryExpr&>(*this));
+        case Kind::NamedExpr:
+            return std::forward<F>(f)(static_cast<NamedExpr&>(*this));
+        case Kind::LiteralExpr:
+            return std::forward<F>(f)(static_cast<LiteralExpr&>(*this));
+        default:
+            throw ParserInternalError{"Expression: invalid node kind"};
+        }
+    }
+    template <typename F>
+    inline decltype(auto) Statement::Visit(F&& f)
+    {
+        switch (kind_)
+        {
+        case Kind::VariableDeclStmt:
+            return std::forward<F>(f)(static_cast<VariableDeclStmt&>(*this));
+        case Kind::JumpStmt:
+            return std::forward<F>(f)(static_cast<JumpStmt&>(*this));
+        case Kind::ReturnStmt:
+            return std::forward<F>(f)(static_cast<ReturnStmt&>(*this));
+        case Kind::CompoundStmt:
+            return std::forward<F>(f)(static_cast<CompoundStmt&>(*this));
+        case Kind::WhileStmt:
+            return std::forward<F>(f)(static_cast<WhileStmt&>(*this));
+        case Kind::ChoiceStmt:
+            return std::forward<F>(f)(static_cast<ChoiceStmt&>(*this));
+        default:
+            throw ParserInternalError{"Statement: invalid node kind"};
+        }
+    }
+
     // Environment
     //
 
@@ -323,6 +479,26 @@ token l_int = "[0-9]+";
 
 ignore whitespace = "[ \t\r\n]+";
 
+# ===================================================
+# Recovery
+#
+
+sync s_semi;
+sync s_rb;
+
+# ===================================================
+# Parallel Parsing
+#
+
+split k_func;
+
+# ===================================================
+# Start Symbols
+#
+
+entry Expr;
+entry Stmt;
+
 # ===================================================
 # Literal
 #
@@ -0,0 +1,117 @@
+#include "core/ast-compact.h"
+#include "core/errors.h"
+#include <typeindex>
+#include <unordered_map>
+
+using namespace std;
+using namespace eds::loli::ast;
+
+namespace eds::loli
+{
+    class AstCompactor
+    {
+    public:
+        AstCompactor(const ParsingMetaInfo& info, Arena& arena)
+            : info_(info), env_(info.Environment()), arena_(arena)
+        {
+            if (env_ == nullptr)
+                throw ParserInternalError{"AstCompactor: proxy manager is required"};
+        }
+
+        AstItemWrapper CopyItem(const TypeSpec& type, AstItemWrapper item)
+        {
+            // tokens, enums and empty items are copied by value
+            if (!item.HasValue())
+            {
+                return item;
+            }
+            else if (type.IsVector())
+            {
+                return CopyVector(type, item);
+            }
+            else if (type.type->IsStoredByRef())
+            {
+                return CopyObject(item);
+            }
+            else
+            {
+                return item;
+            }
+        }
+
+    private:
+        AstItemWrapper CopyObject(AstItemWrapper item)
+        {
+            auto obj = item.Extract<BasicAstObject*>();
+            if (auto it = copied_.find(obj); it != copied_.end())
+            {
+                return it->second;
+            }
+
+            const auto& name  = env_->LookupName(typeid(*obj));
+            const auto klass  = dynamic_cast<const KlassTypeInfo*>(info_.LookupType(name));
+            const auto& proxy = *env_->Lookup(name);
+            assert(klass != nullptr);
+
+            // allocate parent ahead of its children
+            auto result = proxy.ConstructObject(arena_);
+            auto loc    = item.GetLocationInfo();
+            result.UpdateLocationInfo(loc.offset, loc.length);
+
+            copied_[obj] = result;
+
+            for (int i = 0; i < klass->Members().size(); ++i)
+            {
+                const auto& member = klass->Members()[i];
+
+                // NOTE an optional is unwrapped by ExtractField
+                auto member_type = member.type;
+                if (member_type.IsOptional())
+                {
+                    member_type.qual = TypeSpec::Qualifier::None;
+                }
+
+                auto field = CopyItem(member_type, proxy.ExtractField(item, i));
+                if (field.HasValue())
+                {
+                    proxy.AssignField(result, i, field);
+                }
+            }
+
+            return result;
+        }
+
+        AstItemWrapper CopyVector(const TypeSpec& type, AstItemWrapper item)
+        {
+            const auto elem_type = TypeSpec{TypeSpec::Qualifier::None, type.type};
+            const auto& proxy    = *env_->Lookup(type.type->Name());
+
+            auto result = proxy.ConstructVector(arena_);
+            auto loc    = item.GetLocationInfo();
+            result.UpdateLocationInfo(loc.offset, loc.length);
+
+            auto size = proxy.ElementCount(item);
+            proxy.ReserveElements(result, size);
+
+            for (int i = 0; i < size; ++i)
+            {
+                proxy.PushBackElement(result, CopyItem(elem_type, proxy.ExtractElement(item, i)));
+            }
+
+            return result;
+        }
+
+        const ParsingMetaInfo& info_;
+        const ast::AstTypeProxyManager* env_;
+
+        Arena& arena_;
+
+        // preserve sharing in a hash-consed AST
+        unordered_map<const BasicAstObject*, AstItemWrapper> copied_ = {};
+    };
+
+    AstItemWrapper CompactAst(const ParsingMetaInfo& info, Arena& arena, AstItemWrapper root)
+    {
+        return AstCompactor{info, arena}.CopyItem(info.RootVariable().Type(), root);
+    }
+}
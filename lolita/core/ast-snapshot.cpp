@@ -0,0 +1,689 @@
+#include "core/ast-snapshot.h"
+#include "core/errors.h"
+#include <typeindex>
+#include <unordered_map>
+
+using namespace std;
+using namespace eds::loli::ast;
+
+namespace eds::loli
+{
+    static constexpr int32_t kSnapshotMagic   = 0x494C4F4C; // "LOLI"
+    static constexpr int32_t kSnapshotVersion = 2;
+    static constexpr int kHeaderWordCount     = 5;
+    static constexpr int kRecordWordCount     = 3;
+
+    // number of words an item of type takes inline
+    static int ItemWordCount(const TypeSpec& type)
+    {
+        if (type.IsVector())
+            return 1;
+
+        auto inner = type.type->IsStoredByRef() ? 1 : 3;
+        return type.IsOptional() ? 1 + inner : inner;
+    }
+
+    static int KlassWordCount(const KlassTypeInfo& klass)
+    {
+        auto result = kRecordWordCount;
+        for (const auto& member : klass.Members())
+        {
+            result += ItemWordCount(member.type);
+        }
+
+        return result;
+    }
+
+    static TypeSpec ElementTypeOf(const TypeSpec& type)
+    {
+        return TypeSpec{TypeSpec::Qualifier::None, type.type};
+    }
+
+    // FNV-1a hash of token tags and layouts of enums and klasses, which an encoded item depends on
+    static uint64_t LayoutFingerprint(const ParsingMetaInfo& info)
+    {
+        uint64_t result = 0xcbf29ce484222325;
+
+        const auto hash_int = [&](int value) {
+            for (int i = 0; i < 4; ++i)
+            {
+                result = (result ^ ((value >> (i * 8)) & 0xff)) * 0x100000001b3;
+            }
+        };
+        const auto hash_text = [&](const string& text) {
+            hash_int(text.size());
+            for (auto ch : text)
+            {
+                result = (result ^ static_cast<uint8_t>(ch)) * 0x100000001b3;
+            }
+        };
+
+        hash_int(info.Tokens().Size());
+        for (const auto& tok : info.Tokens())
+        {
+            hash_text(tok.Name());
+        }
+
+        hash_int(info.Enums().Size());
+        for (const auto& enum_type : info.Enums())
+        {
+            hash_text(enum_type.Name());
+            hash_int(enum_type.Values().size());
+            for (const auto& value : enum_type.Values())
+            {
+                hash_text(value);
+            }
+        }
+
+        hash_int(info.Klasses().Size());
+        for (const auto& klass : info.Klasses())
+        {
+            hash_text(klass.Name());
+            hash_int(klass.Members().size());
+            for (const auto& member : klass.Members())
+            {
+                hash_text(member.name);
+                hash_text(member.type.type->Name());
+                hash_int(static_cast<int>(member.type.qual));
+            }
+        }
+
+        const auto& root_type = info.RootVariable().Type();
+        hash_text(root_type.type->Name());
+        hash_int(static_cast<int>(root_type.qual));
+
+        return result;
+    }
+
+    static const AstTypeProxyManager& EnvironmentOf(const ParsingMetaInfo& info)
+    {
+        if (info.Environment() == nullptr)
+            throw ParserInternalError{"AstSnapshot: proxy manager is required"};
+
+        return *info.Environment();
+    }
+
+    // =====================================================================================
+    // Writer
+    //
+
+    // NOTE records are laid out in reverse post-order of the AST, where a shared object comes after
+    //      all objects referring to it, so that every reference points forward
+    class AstSnapshotWriter
+    {
+    public:
+        AstSnapshotWriter(const ParsingMetaInfo& info)
+            : info_(info), env_(EnvironmentOf(info)) {}
+
+        vector<int32_t> Write(AstItemWrapper root)
+        {
+            const auto& root_type = info_.RootVariable().Type();
+
+            // collect records in post-order
+            auto root_children = vector<int>{};
+            CollectItem(root_type, root, root_children);
+
+            // lay out records in reverse
+            auto pos = kHeaderWordCount + ItemWordCount(root_type);
+            for (auto it = records_.rbegin(); it != records_.rend(); ++it)
+            {
+                it->pos = pos;
+                pos += it->klass ? KlassWordCount(*it->klass) : kRecordWordCount + it->size * ItemWordCount(ElementTypeOf(it->type));
+            }
+
+            const auto fingerprint = LayoutFingerprint(info_);
+
+            buffer_.assign(pos, 0);
+            buffer_[0] = kSnapshotMagic;
+            buffer_[1] = kSnapshotVersion;
+            buffer_[2] = pos;
+            buffer_[3] = static_cast<int32_t>(fingerprint);
+            buffer_[4] = static_cast<int32_t>(fingerprint >> 32);
+
+            auto next = root_children.cbegin();
+            WriteItem(kHeaderWordCount, root_type, root, next);
+
+            for (const auto& record : records_)
+            {
+                WriteRecord(record);
+            }
+
+            return move(buffer_);
+        }
+
+    private:
+        // an object or a vector to be written
+        struct Record
+        {
+            AstItemWrapper item;
+
+            // klass of an object, or nullptr for a vector of type
+            const KlassTypeInfo* klass;
+            TypeSpec type;
+
+            // element count of a vector
+            int size;
+
+            // records referred to by its items in order
+            vector<int> children;
+
+            int pos;
+        };
+
+        // append records referred to by item, if any, to children
+        void CollectItem(const TypeSpec& type, AstItemWrapper item, vector<int>& children)
+        {
+            if (!item.HasValue())
+                return;
+
+            if (type.IsOptional())
+            {
+                CollectItem(ElementTypeOf(type), item, children);
+            }
+            else if (type.IsVector())
+            {
+                children.push_back(CollectVector(type, item));
+            }
+            else if (type.type->IsStoredByRef())
+            {
+                children.push_back(CollectObject(item));
+            }
+        }
+
+        int CollectObject(AstItemWrapper item)
+        {
+            auto obj = item.Extract<BasicAstObject*>();
+            if (auto it = collected_.find(obj); it != collected_.end())
+            {
+                return it->second;
+            }
+
+            const auto& name  = env_.LookupName(typeid(*obj));
+            const auto klass  = dynamic_cast<const KlassTypeInfo*>(info_.LookupType(name));
+            const auto& proxy = *env_.Lookup(name);
+            assert(klass != nullptr);
+
+            auto children = vector<int>{};
+            for (int i = 0; i < klass->Members().size(); ++i)
+            {
+                CollectItem(klass->Members()[i].type, proxy.ExtractField(item, i), children);
+            }
+
+            auto id         = static_cast<int>(records_.size());
+            collected_[obj] = id;
+            records_.push_back(Record{item, klass, TypeSpec{}, 0, move(children), 0});
+
+            return id;
+        }
+
+        int CollectVector(const TypeSpec& type, AstItemWrapper item)
+        {
+            const auto elem_type = ElementTypeOf(type);
+            const auto& proxy    = *env_.Lookup(type.type->Name());
+
+            auto size     = proxy.ElementCount(item);
+            auto children = vector<int>{};
+            for (int i = 0; i < size; ++i)
+            {
+                CollectItem(elem_type, proxy.ExtractElement(item, i), children);
+            }
+
+            auto id = static_cast<int>(records_.size());
+            records_.push_back(Record{item, nullptr, type, size, move(children), 0});
+
+            return id;
+        }
+
+        void WriteLocation(int pos, AstLocationInfo loc)
+        {
+            buffer_[pos]     = loc.offset;
+            buffer_[pos + 1] = loc.length;
+        }
+
+        // encode item at pos, where next is the record it refers to if any, see CollectItem
+        void WriteItem(int pos, const TypeSpec& type, AstItemWrapper item, vector<int>::const_iterator& next)
+        {
+            if (type.IsOptional())
+            {
+                buffer_[pos] = item.HasValue() ? 1 : 0;
+                if (item.HasValue())
+                {
+                    WriteItem(pos + 1, ElementTypeOf(type), item, next);
+                }
+            }
+            else if (type.IsVector() || type.type->IsStoredByRef())
+            {
+                buffer_[pos] = item.HasValue() ? records_[*next++].pos - pos : 0;
+            }
+            else if (type.type->IsToken())
+            {
+                auto tok = item.HasValue() ? item.Extract<BasicAstToken>() : BasicAstToken{};
+
+                buffer_[pos] = tok.Tag();
+                WriteLocation(pos + 1, tok.GetLocationInfo());
+            }
+            else
+            {
+                assert(type.type->IsEnum());
+                if (item.HasValue())
+                {
+                    buffer_[pos] = env_.Lookup(type.type->Name())->ExtractEnum(item);
+                    WriteLocation(pos + 1, item.GetLocationInfo());
+                }
+                else
+                {
+                    buffer_[pos] = -1;
+                    WriteLocation(pos + 1, {-1, -1});
+                }
+            }
+        }
+
+        void WriteRecord(const Record& record)
+        {
+            auto next = record.children.cbegin();
+            auto item = record.item;
+
+            if (record.klass)
+            {
+                const auto& klass = *record.klass;
+                const auto& proxy = *env_.Lookup(klass.Name());
+
+                buffer_[record.pos] = static_cast<int32_t>(record.klass - &info_.Klasses()[0]);
+                WriteLocation(record.pos + 1, item.GetLocationInfo());
+
+                auto field_pos = record.pos + kRecordWordCount;
+                for (int i = 0; i < klass.Members().size(); ++i)
+                {
+                    const auto& member = klass.Members()[i];
+
+                    WriteItem(field_pos, member.type, proxy.ExtractField(item, i), next);
+                    field_pos += ItemWordCount(member.type);
+                }
+            }
+            else
+            {
+                const auto elem_type  = ElementTypeOf(record.type);
+                const auto elem_count = ItemWordCount(elem_type);
+                const auto& proxy     = *env_.Lookup(record.type.type->Name());
+
+                buffer_[record.pos] = record.size;
+                WriteLocation(record.pos + 1, item.GetLocationInfo());
+
+                for (int i = 0; i < record.size; ++i)
+                {
+                    WriteItem(record.pos + kRecordWordCount + i * elem_count, elem_type, proxy.ExtractElement(item, i), next);
+                }
+            }
+
+            assert(next == record.children.cend());
+        }
+
+        const ParsingMetaInfo& info_;
+        const AstTypeProxyManager& env_;
+
+        vector<int32_t> buffer_                              = {};
+        vector<Record> records_                              = {};
+        unordered_map<const BasicAstObject*, int> collected_ = {};
+    };
+
+    // =====================================================================================
+    // Reader
+    //
+
+    static void VerifySnapshotHeader(const ParsingMetaInfo& info, ArrayRef<const int32_t> data)
+    {
+        if (data.Length() < kHeaderWordCount ||
+            data.At(0) != kSnapshotMagic ||
+            data.At(1) != kSnapshotVersion ||
+            data.At(2) != data.Length())
+        {
+            throw ParserInternalError{"AstSnapshot: invalid snapshot header"};
+        }
+
+        const auto fingerprint = LayoutFingerprint(info);
+        if (data.At(3) != static_cast<int32_t>(fingerprint) ||
+            data.At(4) != static_cast<int32_t>(fingerprint >> 32))
+        {
+            throw ParserInternalError{"AstSnapshot: snapshot of a different grammar"};
+        }
+    }
+
+    // position of the record of type referred to at ref_pos, or 0 if null
+    // NOTE a reference should point strictly forward to a record inside data,
+    //      so that reading even a corrupt snapshot always terminates
+    static int FollowReference(const ParsingMetaInfo& info, ArrayRef<const int32_t> data, int ref_pos, const TypeSpec& type)
+    {
+        auto ref = data.At(ref_pos);
+        if (ref == 0)
+            return 0;
+
+        if (ref < 0 || ref > data.Length() - kRecordWordCount - ref_pos)
+            throw ParserInternalError{"AstSnapshot: invalid reference"};
+
+        auto pos        = ref_pos + ref;
+        auto word_count = int64_t{0};
+        if (type.IsVector())
+        {
+            auto size = data.At(pos);
+            if (size < 0)
+                throw ParserInternalError{"AstSnapshot: invalid vector size"};
+
+            word_count = kRecordWordCount + int64_t{size} * ItemWordCount(ElementTypeOf(type));
+        }
+        else
+        {
+            auto klass_id = data.At(pos);
+            if (klass_id < 0 || klass_id >= info.Klasses().Size())
+                throw ParserInternalError{"AstSnapshot: invalid klass index"};
+
+            const auto& klass = info.Klasses()[klass_id];
+            if (&klass != type.type && klass.BaseType() != type.type)
+                throw ParserInternalError{"AstSnapshot: klass mismatches the type of reference"};
+
+            word_count = KlassWordCount(klass);
+        }
+
+        if (pos + word_count > data.Length())
+            throw ParserInternalError{"AstSnapshot: record out of range"};
+
+        return pos;
+    }
+
+    class AstSnapshotReader
+    {
+    public:
+        AstSnapshotReader(const ParsingMetaInfo& info, Arena& arena, ArrayRef<const int32_t> data)
+            : info_(info), env_(EnvironmentOf(info)), arena_(arena), data_(data) {}
+
+        AstItemWrapper Read()
+        {
+            VerifySnapshotHeader(info_, data_);
+
+            return ReadItem(kHeaderWordCount, info_.RootVariable().Type());
+        }
+
+    private:
+        int32_t At(int pos)
+        {
+            if (pos < kHeaderWordCount || pos >= data_.Length())
+                throw ParserInternalError{"AstSnapshot: position out of range"};
+
+            return data_.At(pos);
+        }
+
+        AstItemWrapper ReadItem(int pos, const TypeSpec& type)
+        {
+            if (type.IsOptional())
+            {
+                return At(pos) != 0 ? ReadItem(pos + 1, ElementTypeOf(type)) : AstItemWrapper{};
+            }
+            else if (type.IsVector())
+            {
+                auto record_pos = FollowReference(info_, data_, pos, type);
+                return record_pos != 0 ? ReadVector(record_pos, type) : AstItemWrapper{};
+            }
+            else if (type.type->IsStoredByRef())
+            {
+                auto record_pos = FollowReference(info_, data_, pos, type);
+                return record_pos != 0 ? ReadObject(record_pos) : AstItemWrapper{};
+            }
+            else if (type.type->IsToken())
+            {
+                auto tag = At(pos);
+                return tag != -1 ? BasicAstToken{At(pos + 1), At(pos + 2), tag} : AstItemWrapper{};
+            }
+            else
+            {
+                assert(type.type->IsEnum());
+
+                auto value = At(pos);
+                if (value == -1)
+                    return AstItemWrapper{};
+
+                auto result = env_.Lookup(type.type->Name())->ConstructEnum(value);
+                result.UpdateLocationInfo(At(pos + 1), At(pos + 2));
+
+                return result;
+            }
+        }
+
+        AstItemWrapper ReadObject(int pos)
+        {
+            if (auto it = loaded_.find(pos); it != loaded_.end())
+            {
+                return it->second;
+            }
+
+            // NOTE the record is verified by FollowReference
+            const auto& klass = info_.Klasses()[At(pos)];
+            const auto& proxy = *env_.Lookup(klass.Name());
+
+            auto result = proxy.ConstructObject(arena_);
+            result.UpdateLocationInfo(At(pos + 1), At(pos + 2));
+
+            auto field_pos = pos + kRecordWordCount;
+            for (int i = 0; i < klass.Members().size(); ++i)
+            {
+                const auto& member = klass.Members()[i];
+
+                if (auto field = ReadItem(field_pos, member.type); field.HasValue())
+                {
+                    proxy.AssignField(result, i, field);
+                }
+
+                field_pos += ItemWordCount(member.type);
+            }
+
+            return loaded_[pos] = result;
+        }
+
+        AstItemWrapper ReadVector(int pos, const TypeSpec& type)
+        {
+            const auto elem_type  = ElementTypeOf(type);
+            const auto elem_count = ItemWordCount(elem_type);
+            const auto& proxy     = *env_.Lookup(type.type->Name());
+
+            auto result = proxy.ConstructVector(arena_);
+            result.UpdateLocationInfo(At(pos + 1), At(pos + 2));
+
+            auto size = At(pos);
+            for (int i = 0; i < size; ++i)
+            {
+                proxy.PushBackElement(result, ReadItem(pos + kRecordWordCount + i * elem_count, elem_type));
+            }
+
+            return result;
+        }
+
+        const ParsingMetaInfo& info_;
+        const AstTypeProxyManager& env_;
+
+        Arena& arena_;
+        ArrayRef<const int32_t> data_;
+
+        unordered_map<int, AstItemWrapper> loaded_ = {};
+    };
+
+    vector<int32_t> SaveAstSnapshot(const ParsingMetaInfo& info, AstItemWrapper root)
+    {
+        return AstSnapshotWriter{info}.Write(root);
+    }
+
+    AstItemWrapper LoadAstSnapshot(const ParsingMetaInfo& info, Arena& arena, ArrayRef<const int32_t> data)
+    {
+        return AstSnapshotReader{info, arena, data}.Read();
+    }
+
+    // =====================================================================================
+    // Implementation of AstSnapshotView
+    //
+
+    AstSnapshotView::AstSnapshotView(const ParsingMetaInfo& info, ArrayRef<const int32_t> data)
+        : info_(info), data_(data)
+    {
+        VerifySnapshotHeader(info_, data_);
+    }
+
+    AstSnapshotNode AstSnapshotView::Root() const
+    {
+        const auto& root_type = info_.RootVariable().Type();
+        if (!root_type.IsVector() && !root_type.type->IsStoredByRef())
+            throw ParserInternalError{"AstSnapshotView: root is neither an object nor a vector"};
+
+        return AstSnapshotNode{this, FollowReference(info_, data_, kHeaderWordCount, root_type), root_type};
+    }
+
+    // =====================================================================================
+    // Implementation of AstSnapshotNode
+    //
+
+    const KlassTypeInfo& AstSnapshotNode::Klass() const
+    {
+        assert(!IsNull() && !IsVector());
+        return view_->Info().Klasses()[view_->Data().At(pos_)];
+    }
+
+    AstLocationInfo AstSnapshotNode::GetLocationInfo() const
+    {
+        assert(!IsNull());
+        return AstLocationInfo{view_->Data().At(pos_ + 1), view_->Data().At(pos_ + 2)};
+    }
+
+    BasicAstToken AstSnapshotNode::Token(int ordinal) const
+    {
+        TypeSpec type;
+        auto pos = MemberPosition(ordinal, type);
+
+        if (!type.type->IsToken())
+            throw ParserInternalError{"AstSnapshotNode: member is not a token"};
+
+        const auto& data = view_->Data();
+        if (type.IsOptional())
+        {
+            if (data.At(pos) == 0)
+                return BasicAstToken{};
+
+            pos += 1;
+        }
+
+        return BasicAstToken{data.At(pos + 1), data.At(pos + 2), data.At(pos)};
+    }
+
+    int AstSnapshotNode::Enum(int ordinal) const
+    {
+        TypeSpec type;
+        auto pos = MemberPosition(ordinal, type);
+
+        if (!type.type->IsEnum())
+            throw ParserInternalError{"AstSnapshotNode: member is not an enum"};
+
+        const auto& data = view_->Data();
+        if (type.IsOptional())
+        {
+            if (data.At(pos) == 0)
+                return -1;
+
+            pos += 1;
+        }
+
+        return data.At(pos);
+    }
+
+    AstSnapshotNode AstSnapshotNode::Object(int ordinal) const
+    {
+        TypeSpec type;
+        auto pos = MemberPosition(ordinal, type);
+
+        if (type.IsVector() || !type.type->IsStoredByRef())
+            throw ParserInternalError{"AstSnapshotNode: member is not an object"};
+
+        if (type.IsOptional())
+        {
+            if (view_->Data().At(pos) == 0)
+                return AstSnapshotNode{view_, 0, ElementTypeOf(type)};
+
+            pos += 1;
+        }
+
+        return Follow(pos, ElementTypeOf(type));
+    }
+
+    AstSnapshotNode AstSnapshotNode::Vector(int ordinal) const
+    {
+        TypeSpec type;
+        auto pos = MemberPosition(ordinal, type);
+
+        if (!type.IsVector())
+            throw ParserInternalError{"AstSnapshotNode: member is not a vector"};
+
+        return Follow(pos, type);
+    }
+
+    int AstSnapshotNode::Size() const
+    {
+        assert(!IsNull() && IsVector());
+        return view_->Data().At(pos_);
+    }
+
+    BasicAstToken AstSnapshotNode::TokenElement(int index) const
+    {
+        TypeSpec type;
+        auto pos = ElementPosition(index, type);
+
+        if (!type.type->IsToken())
+            throw ParserInternalError{"AstSnapshotNode: element is not a token"};
+
+        const auto& data = view_->Data();
+        return BasicAstToken{data.At(pos + 1), data.At(pos + 2), data.At(pos)};
+    }
+
+    int AstSnapshotNode::EnumElement(int index) const
+    {
+        TypeSpec type;
+        auto pos = ElementPosition(index, type);
+
+        if (!type.type->IsEnum())
+            throw ParserInternalError{"AstSnapshotNode: element is not an enum"};
+
+        return view_->Data().At(pos);
+    }
+
+    AstSnapshotNode AstSnapshotNode::Element(int index) const
+    {
+        TypeSpec type;
+        auto pos = ElementPosition(index, type);
+
+        if (!type.type->IsStoredByRef())
+            throw ParserInternalError{"AstSnapshotNode: element is not an object"};
+
+        return Follow(pos, type);
+    }
+
+    int AstSnapshotNode::MemberPosition(int ordinal, TypeSpec& type) const
+    {
+        const auto& members = Klass().Members();
+        assert(ordinal >= 0 && ordinal < members.size());
+
+        auto pos = pos_ + kRecordWordCount;
+        for (int i = 0; i < ordinal; ++i)
+        {
+            pos += ItemWordCount(members[i].type);
+        }
+
+        type = members[ordinal].type;
+        return pos;
+    }
+
+    int AstSnapshotNode::ElementPosition(int index, TypeSpec& type) const
+    {
+        assert(index >= 0 && index < Size());
+
+        type = ElementTypeOf(type_);
+        return pos_ + kRecordWordCount + index * ItemWordCount(type);
+    }
+
+    AstSnapshotNode AstSnapshotNode::Follow(int ref_pos, TypeSpec type) const
+    {
+        return AstSnapshotNode{view_, FollowReference(view_->Info(), view_->Data(), ref_pos, type), type};
+    }
+}
@@ -0,0 +1,565 @@
+#include "core/compiled-grammar.h"
+#include "core/trace.h"
+#include "lexing/lexing-automaton.h"
+#include "parsing/parsing-automaton.h"
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using namespace eds::container;
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // Implementation of CompiledGrammar
+    //
+
+    ParsingAction TranslateAction(parsing::PdaEdge action)
+    {
+        struct Visitor
+        {
+            ParsingAction operator()(parsing::PdaEdgeReduce edge)
+            {
+                return ActionReduce{edge.production};
+            }
+            ParsingAction operator()(parsing::PdaEdgeShift edge)
+            {
+                return ActionShift{edge.target->Id()};
+            }
+        };
+
+        return visit(Visitor{}, action);
+    }
+
+    // ids of variables an error node may stand for, where a variable comes before those whose productions lead with it,
+    // i.e. the innermost pending variable is assumed, and ties are broken by id
+    // NOTE an error node is an empty list or optional if the variable is one, otherwise an empty item,
+    //      so a variable is excluded if its empty item may reach the root, or an object or list selected to be modified
+    vector<int> OrderRecoveryVariables(const ParsingMetaInfo& info, const HeapArray<bool>& accepting_variable_lookup)
+    {
+        const auto& variables    = info.Variables();
+        const auto variable_num = variables.Size();
+
+        // leading[x][y] if a sentential form derived from x leads with y
+        auto leading = vector<vector<bool>>(variable_num, vector<bool>(variable_num, false));
+        for (const auto& production : info.Productions())
+        {
+            if (production.Right().empty() || !production.Right().front()->IsVariable())
+                continue;
+
+            leading[production.Left()->Id()][production.Right().front()->AsVariable()->Id()] = true;
+        }
+
+        for (int k = 0; k < variable_num; ++k)
+        {
+            for (int i = 0; i < variable_num; ++i)
+            {
+                if (!leading[i][k])
+                    continue;
+
+                for (int j = 0; j < variable_num; ++j)
+                {
+                    if (leading[k][j])
+                        leading[i][j] = true;
+                }
+            }
+        }
+
+        // unsafe[x] if an empty item of x may reach the root, or an item modified after selected
+        auto unsafe = vector<bool>(variable_num, false);
+        for (int id = 0; id < variable_num; ++id)
+        {
+            unsafe[id] = accepting_variable_lookup[id];
+        }
+
+        for (auto changed = true; changed;)
+        {
+            changed = false;
+            for (const auto& production : info.Productions())
+            {
+                const auto& handle = *production.Handle();
+                const auto selector = get_if<ast::AstItemSelector>(&handle.Generator());
+                if (selector == nullptr || !production.Right()[selector->Index()]->IsVariable())
+                    continue;
+
+                const auto selected = production.Right()[selector->Index()]->AsVariable()->Id();
+                const auto modified = !holds_alternative<ast::AstManipPlaceholder>(handle.Manipulator());
+                if ((modified || unsafe[production.Left()->Id()]) && !unsafe[selected])
+                {
+                    unsafe[selected] = true;
+                    changed          = true;
+                }
+            }
+        }
+
+        auto result = vector<int>{};
+        for (const auto& variable : variables)
+        {
+            const auto& type = variable.Type();
+            const auto empty = type.IsNoneQualified() || type.type->IsToken();
+
+            // NOTE markers of start symbols have no production and are never assumed
+            if (!variable.Productions().empty() && !(empty && unsafe[variable.Id()]))
+                result.push_back(variable.Id());
+        }
+
+        // a variable leads with fewer variables than those leading with it
+        auto depth = [&](int id) {
+            return count(leading[id].begin(), leading[id].end(), true) - (leading[id][id] ? 1 : 0);
+        };
+        stable_sort(result.begin(), result.end(), [&](int lhs, int rhs) { return depth(lhs) < depth(rhs); });
+
+        return result;
+    }
+
+    void CompiledGrammar::Initialize(const string& config, const ast::AstTypeProxyManager* env, size_t table_budget)
+    {
+        assert(!config.empty() && env != nullptr);
+
+        TraceSpan span{"CompileGrammar", "construction"};
+
+        // resolve basic grammar information
+        //
+        info_ = ResolveParsingInfo(config, env);
+
+        // computes automata
+        //
+        auto dfa = lexing::BuildLexingAutomaton(*info_);
+        auto pda = parsing::BuildLALRAutomaton(*info_);
+
+        // initialize stores
+        //
+
+        TraceSpan copying_span{"CopyTables", "construction"};
+
+        // basic grammar information
+        token_num_   = info_->Tokens().Size() + info_->IgnoredTokens().Size();
+        term_num_    = info_->Tokens().Size();
+        nonterm_num_ = info_->Variables().Size();
+
+        dfa_state_num_ = dfa->StateCount();
+        pda_state_num_ = pda->StateCount();
+
+        // tables are copied densely first, see CompactTables
+        encoding_         = TableEncoding::Dense;
+        lexing_class_num_ = 128;
+
+        // lexing table
+        acc_token_lookup_.Initialize(dfa->StateCount(), nullptr);
+        lexing_class_lookup_.Initialize(128, 0);
+        lexing_table_.Initialize(128 * dfa_state_num_, -1);
+
+        for (int ch = 0; ch < 128; ++ch)
+        {
+            lexing_class_lookup_[ch] = ch;
+        }
+
+        // parsing table
+        action_row_lookup_.Initialize(pda_state_num_, 0);
+        goto_row_lookup_.Initialize(pda_state_num_, 0);
+        eof_action_table_.Initialize(pda_state_num_, ActionError{});
+        action_table_.Initialize(pda_state_num_ * term_num_, ActionError{});
+        goto_table_.Initialize(pda_state_num_ * nonterm_num_, -1);
+
+        for (int id = 0; id < pda_state_num_; ++id)
+        {
+            action_row_lookup_[id] = id * term_num_;
+            goto_row_lookup_[id]   = id * nonterm_num_;
+        }
+
+        // recovery
+        sync_token_lookup_.Initialize(term_num_, false);
+        for (const auto token : info_->SyncTokens())
+        {
+            sync_token_lookup_[token->Id()] = true;
+        }
+
+        // parallel parsing
+        split_token_lookup_.Initialize(term_num_, false);
+        for (const auto token : info_->SplitTokens())
+        {
+            split_token_lookup_[token->Id()] = true;
+        }
+
+        // multiple start symbols
+        accepting_variable_lookup_.Initialize(nonterm_num_, false);
+        accepting_variable_lookup_[info_->RootVariable().Id()] = true;
+
+        entry_state_table_.Initialize(info_->Entries().size(), -1);
+        for (int i = 0; i < entry_state_table_.Size(); ++i)
+        {
+            const auto& entry = info_->Entries()[i];
+
+            accepting_variable_lookup_[entry.augmented->Id()] = true;
+            entry_state_table_[i]                             = pda->LookupState(0)->GotoMap().at(entry.marker)->Id();
+        }
+
+        // variables assumed by recovery, which must not stand for accepting ones with an empty item
+        auto recovery_variables = OrderRecoveryVariables(*info_, accepting_variable_lookup_);
+        recovery_variables_.Initialize(recovery_variables.size());
+        copy(recovery_variables.begin(), recovery_variables.end(), recovery_variables_.begin());
+
+        // copy lexing automaton
+        //
+        for (int id = 0; id < dfa_state_num_; ++id)
+        {
+            const auto state = dfa->LookupState(id);
+
+            acc_token_lookup_[id] = state->acc_token;
+            for (const auto edge : state->transitions)
+            {
+                lexing_table_[id * 128 + edge.first] = edge.second->id;
+            }
+        }
+
+        // copy parsing automaton
+        //
+        for (int src_state_id = 0; src_state_id < pda_state_num_; ++src_state_id)
+        {
+            auto state = pda->LookupState(src_state_id);
+
+            if (state->EofAction())
+            {
+                eof_action_table_[src_state_id] = TranslateAction(*state->EofAction());
+            }
+
+            for (const auto& pair : state->ActionMap())
+            {
+                const auto tok_id = pair.first->Id();
+
+                action_table_[src_state_id * term_num_ + tok_id] = TranslateAction(pair.second);
+            }
+
+            for (const auto& pair : state->GotoMap())
+            {
+                // NOTE markers are only shifted when a parse starts, see entry_state_table_,
+                //      so that error recovery never assumes one
+                if (pair.first->Productions().empty())
+                    continue;
+
+                const auto var_id = pair.first->Id();
+
+                goto_table_[src_state_id * nonterm_num_ + var_id] = pair.second->Id();
+            }
+        }
+
+        // fit tables in the budget
+        //
+        if (table_budget > 0 && Footprint().TableBytes() > table_budget)
+        {
+            CompactTables();
+
+            if (Footprint().TableBytes() > table_budget)
+                throw ParserConstructionError{"CompileGrammar: tables exceed the budget even if compact"};
+        }
+
+        copying_span.Count("lexing_cells", lexing_table_.Size());
+        copying_span.Count("action_cells", action_table_.Size() + eof_action_table_.Size());
+        copying_span.Count("goto_cells", goto_table_.Size());
+
+        // automata are done with
+        //
+        info_->ReleaseConstructionData();
+    }
+
+    namespace
+    {
+        // pack rows of table into fewer cells by row displacement, where a row of column_num cells starting at its offset
+        // in row_lookup is moved to another offset, so that its non-empty cells overlap no non-empty cell of other rows,
+        // and check is filled with the row owning each cell, or -1 if none
+        template <typename T, typename F>
+        void PackSparseRows(HeapArray<T>& table, HeapArray<int>& row_lookup, HeapArray<int>& check, int column_num, F is_empty)
+        {
+            auto columns = vector<vector<int>>(row_lookup.Size());
+            for (int id = 0; id < row_lookup.Size(); ++id)
+            {
+                for (int i = 0; i < column_num; ++i)
+                {
+                    if (!is_empty(table[row_lookup[id] + i]))
+                        columns[id].push_back(i);
+                }
+            }
+
+            // rows with more cells are placed first, which are harder to fit in
+            auto order = vector<int>(row_lookup.Size());
+            for (int id = 0; id < order.size(); ++id)
+            {
+                order[id] = id;
+            }
+
+            stable_sort(order.begin(), order.end(), [&](int lhs, int rhs) {
+                return columns[lhs].size() > columns[rhs].size();
+            });
+
+            auto cells      = vector<T>{};
+            auto owners     = vector<int>{};
+            auto offsets    = vector<int>(row_lookup.Size(), 0);
+            auto first_free = 0;
+            for (auto id : order)
+            {
+                const auto& row = columns[id];
+                if (row.empty())
+                    continue;
+
+                auto fits = [&](int offset) {
+                    for (auto i : row)
+                    {
+                        if (offset + i < owners.size() && owners[offset + i] != -1)
+                            return false;
+                    }
+
+                    return true;
+                };
+
+                auto offset = max(0, first_free - row.front());
+                while (!fits(offset))
+                    offset += 1;
+
+                if (owners.size() < offset + column_num)
+                {
+                    cells.resize(offset + column_num, T{});
+                    owners.resize(offset + column_num, -1);
+                }
+
+                for (auto i : row)
+                {
+                    cells[offset + i]  = table[row_lookup[id] + i];
+                    owners[offset + i] = id;
+                }
+
+                offsets[id] = offset;
+                while (first_free < owners.size() && owners[first_free] != -1)
+                    first_free += 1;
+            }
+
+            // NOTE an empty row is left at offset 0, where it owns no cell
+            if (owners.size() < column_num)
+            {
+                cells.resize(column_num, T{});
+                owners.resize(column_num, -1);
+            }
+
+            table.Initialize(cells.size(), T{});
+            check.Initialize(owners.size(), -1);
+            for (int i = 0; i < cells.size(); ++i)
+            {
+                table[i] = cells[i];
+                check[i] = owners[i];
+            }
+
+            for (int id = 0; id < row_lookup.Size(); ++id)
+            {
+                row_lookup[id] = offsets[id];
+            }
+        }
+    }
+
+    void CompiledGrammar::CompactTables()
+    {
+        assert(encoding_ == TableEncoding::Dense);
+
+        // characters of the same class have the same transition in every lexing state
+        auto class_lookup = map<vector<int>, int>{};
+        for (int ch = 0; ch < 128; ++ch)
+        {
+            auto column = vector<int>{};
+            for (int id = 0; id < dfa_state_num_; ++id)
+            {
+                column.push_back(lexing_table_[id * 128 + ch]);
+            }
+
+            auto iter                = class_lookup.try_emplace(move(column), static_cast<int>(class_lookup.size())).first;
+            lexing_class_lookup_[ch] = iter->second;
+        }
+
+        lexing_class_num_ = class_lookup.size();
+        lexing_table_.Initialize(lexing_class_num_ * dfa_state_num_, -1);
+        for (const auto& pair : class_lookup)
+        {
+            for (int id = 0; id < dfa_state_num_; ++id)
+            {
+                lexing_table_[id * lexing_class_num_ + pair.second] = pair.first[id];
+            }
+        }
+
+        // most cells of parsing tables are errors
+        PackSparseRows(action_table_, action_row_lookup_, action_check_, term_num_, [](const ParsingAction& action) {
+            return holds_alternative<ActionError>(action);
+        });
+        PackSparseRows(goto_table_, goto_row_lookup_, goto_check_, nonterm_num_, [](int target) {
+            return target == -1;
+        });
+
+        encoding_ = TableEncoding::Compact;
+    }
+
+    TableFootprint CompiledGrammar::Footprint() const
+    {
+        auto bytes = [](const auto& table) {
+            return table.Size() * sizeof(*table.begin());
+        };
+
+        auto result     = TableFootprint{};
+        result.encoding = encoding_;
+
+        result.lexing_table_bytes     = bytes(lexing_table_);
+        result.acc_token_lookup_bytes = bytes(acc_token_lookup_);
+        result.action_table_bytes     = bytes(action_table_) + bytes(action_check_);
+        result.eof_action_table_bytes = bytes(eof_action_table_);
+        result.goto_table_bytes       = bytes(goto_table_) + bytes(goto_check_);
+
+        result.auxiliary_bytes = bytes(lexing_class_lookup_) + bytes(action_row_lookup_) + bytes(goto_row_lookup_) +
+                                 bytes(sync_token_lookup_) + bytes(split_token_lookup_) + bytes(recovery_variables_) +
+                                 bytes(accepting_variable_lookup_) + bytes(entry_state_table_);
+
+        result.meta_info_bytes = info_->MemoryFootprint();
+
+        return result;
+    }
+
+    std::unique_ptr<const CompiledGrammar> CompileGrammar(const string& config, const ast::AstTypeProxyManager* env, size_t table_budget)
+    {
+        auto result = make_unique<CompiledGrammar>();
+        result->Initialize(config, env, table_budget);
+
+        return result;
+    }
+
+    // =====================================================================================
+    // Implementation of Grammar Registry
+    //
+
+    namespace
+    {
+        struct GrammarKey
+        {
+            string config;
+            const ast::AstTypeProxyManager* env;
+            size_t table_budget;
+
+            bool operator==(const GrammarKey& other) const
+            {
+                return env == other.env && table_budget == other.table_budget && config == other.config;
+            }
+        };
+
+        struct GrammarKeyHasher
+        {
+            size_t operator()(const GrammarKey& key) const
+            {
+                auto result = hash<string>{}(key.config);
+                result ^= hash<const void*>{}(key.env) + 0x9e3779b9 + (result << 6) + (result >> 2);
+                result ^= hash<size_t>{}(key.table_budget) + 0x9e3779b9 + (result << 6) + (result >> 2);
+
+                return result;
+            }
+        };
+
+        // a shared grammar, which is being compiled while compiling is valid
+        struct GrammarSlot
+        {
+            shared_future<shared_ptr<const CompiledGrammar>> compiling;
+            weak_ptr<const CompiledGrammar> grammar;
+        };
+
+        struct GrammarRegistry
+        {
+            mutex lock;
+            unordered_map<GrammarKey, GrammarSlot, GrammarKeyHasher> grammars;
+
+            static GrammarRegistry& Instance()
+            {
+                static GrammarRegistry registry{};
+
+                return registry;
+            }
+
+            // drop slots whose grammars are gone, returns the number dropped
+            // NOTE lock must be held
+            int DropExpired()
+            {
+                auto result = 0;
+                for (auto iter = grammars.begin(); iter != grammars.end();)
+                {
+                    if (!iter->second.compiling.valid() && iter->second.grammar.expired())
+                    {
+                        iter = grammars.erase(iter);
+                        result += 1;
+                    }
+                    else
+                    {
+                        ++iter;
+                    }
+                }
+
+                return result;
+            }
+        };
+    }
+
+    std::shared_ptr<const CompiledGrammar> LoadSharedGrammar(const string& config, const ast::AstTypeProxyManager* env, size_t table_budget)
+    {
+        auto& registry = GrammarRegistry::Instance();
+        auto key       = GrammarKey{config, env, table_budget};
+
+        unique_lock<mutex> guard{registry.lock};
+        registry.DropExpired();
+
+        auto& slot = registry.grammars[key];
+        if (auto grammar = slot.grammar.lock())
+        {
+            return grammar;
+        }
+
+        if (slot.compiling.valid())
+        {
+            // wait for the caller compiling it, which rethrows its exception
+            auto compiling = slot.compiling;
+            guard.unlock();
+
+            return compiling.get();
+        }
+
+        auto compiled  = promise<shared_ptr<const CompiledGrammar>>{};
+        slot.compiling = compiled.get_future().share();
+        guard.unlock();
+
+        // compile outside of the lock so that other grammars are not blocked
+        auto grammar = shared_ptr<const CompiledGrammar>{};
+        try
+        {
+            grammar = CompileGrammar(config, env, table_budget);
+        }
+        catch (...)
+        {
+            // NOTE nothing is registered if compilation throws
+            guard.lock();
+            registry.grammars.erase(key);
+            guard.unlock();
+
+            compiled.set_exception(current_exception());
+            throw;
+        }
+
+        guard.lock();
+        slot.grammar   = grammar;
+        slot.compiling = {};
+        guard.unlock();
+
+        compiled.set_value(grammar);
+        return grammar;
+    }
+
+    int ReleaseUnusedGrammars()
+    {
+        auto& registry = GrammarRegistry::Instance();
+
+        lock_guard<mutex> guard{registry.lock};
+        return registry.DropExpired();
+    }
+}
@@ -190,6 +190,30 @@ namespace eds::loli::config
             NodeDefinition{move(name), move(parent), move(members)});
     }
 
+    void ParseSyncDefinition(ParsingConfiguration& config, zstring& s)
+    {
+        auto name = ParseIdentifier(s);
+        ParseConstant(s, ";");
+
+        config.sync_tokens.push_back(move(name));
+    }
+
+    void ParseSplitDefinition(ParsingConfiguration& config, zstring& s)
+    {
+        auto name = ParseIdentifier(s);
+        ParseConstant(s, ";");
+
+        config.split_tokens.push_back(move(name));
+    }
+
+    void ParseEntryDefinition(ParsingConfiguration& config, zstring& s)
+    {
+        auto name = ParseIdentifier(s);
+        ParseConstant(s, ";");
+
+        config.entries.push_back(move(name));
+    }
+
     void ParseRuleDefinition(ParsingConfiguration& config, zstring& s)
     {
         auto name = ParseIdentifier(s);
@@ -250,8 +274,14 @@ namespace eds::loli::config
                 }
             }
 
+            auto action = ""s;
+            if (TryParseConstant(s, "@"))
+            {
+                action = ParseIdentifier(s);
+            }
+
             items.push_back(
-                RuleItem{move(rhs), move(klass_hint)});
+                RuleItem{move(rhs), move(klass_hint), move(action)});
 
             if (TryParseConstant(s, ";"))
                 break;
@@ -289,6 +319,18 @@ namespace eds::loli::config
             {
                 ParseRuleDefinition(config, s);
             }
+            else if (TryParseConstant(s, "sync"))
+            {
+                ParseSyncDefinition(config, s);
+            }
+            else if (TryParseConstant(s, "split"))
+            {
+                ParseSplitDefinition(config, s);
+            }
+            else if (TryParseConstant(s, "entry"))
+            {
+                ParseEntryDefinition(config, s);
+            }
             else
             {
                 throw ConfigParsingError{s, "unexpected token"};
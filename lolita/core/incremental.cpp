@@ -0,0 +1,103 @@
+#include "core/incremental.h"
+
+using namespace std;
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // Implementation of IncrementalDocument
+    //
+
+    void IncrementalDocument::CompactNodes()
+    {
+        assert(root_node_ != -1);
+
+        auto child_count = [](const Node& node) {
+            return node.production ? static_cast<int>(node.production->Right().size()) : 0;
+        };
+
+        // mark nodes reachable from the root, which always follow their children
+        auto reachable        = vector<bool>(nodes_.size(), false);
+        reachable[root_node_] = true;
+
+        for (int i = root_node_; i >= 0; --i)
+        {
+            if (!reachable[i])
+                continue;
+
+            const auto& node = nodes_[i];
+            for (int k = 0; k < child_count(node); ++k)
+            {
+                reachable[child_pool_[node.first_child + k]] = true;
+            }
+        }
+
+        // move reachable nodes forward, where children are moved ahead of their parent
+        auto remap      = vector<int>(nodes_.size(), -1);
+        auto nodes      = vector<Node>{};
+        auto child_pool = vector<int>{};
+
+        nodes.reserve(nodes_[root_node_].node_count);
+        for (int i = 0; i <= root_node_; ++i)
+        {
+            if (!reachable[i])
+                continue;
+
+            auto node = nodes_[i];
+            if (node.production)
+            {
+                const auto first_child = static_cast<int>(child_pool.size());
+                for (int k = 0; k < child_count(node); ++k)
+                {
+                    child_pool.push_back(remap[child_pool_[node.first_child + k]]);
+                }
+
+                node.first_child = first_child;
+            }
+
+            remap[i] = nodes.size();
+            nodes.push_back(node);
+        }
+
+        nodes_      = move(nodes);
+        child_pool_ = move(child_pool);
+        root_node_  = remap[root_node_];
+    }
+
+    void IncrementalDocument::RebuildArena()
+    {
+        assert(root_node_ != -1 && root_node_ == static_cast<int>(nodes_.size()) - 1);
+
+        auto arena  = make_unique<Arena>();
+        auto values = vector<ast::AstItemWrapper>{};
+
+        // reduce nodes again in order, where children are always reconstructed ahead of their parent
+        // NOTE tokens are stored in nodes as they are
+        for (auto& node : nodes_)
+        {
+            if (node.production == nullptr)
+                continue;
+
+            values.clear();
+            for (int k = 0; k < node.production->Right().size(); ++k)
+            {
+                values.push_back(nodes_[child_pool_[node.first_child + k]].value);
+            }
+
+            auto value = node.production->Handle()->Invoke(*arena, ArrayRef<ast::AstItemWrapper>(values.data(), values.size()));
+
+            // locations are anchors, which are taken as they are
+            if (value.HasValue() && node.value.HasValue())
+            {
+                const auto location = node.value.GetLocationInfo();
+                value.UpdateLocationInfo(location.offset, location.length);
+            }
+
+            node.value = value;
+        }
+
+        root_             = nodes_[root_node_].value;
+        arena_            = move(arena);
+        arena_node_count_ = nodes_.size();
+    }
+}
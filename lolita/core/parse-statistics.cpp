@@ -0,0 +1,117 @@
+#include "core/parse-statistics.h"
+#include "core/debug.h"
+#include <algorithm>
+#include <iomanip>
+
+using namespace std;
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // Implementation of ParseStatistics
+    //
+
+    int64_t ParseStatistics::ReductionCount() const
+    {
+        int64_t result = 0;
+        for (const auto& counter : productions)
+            result += counter.reduction_count;
+
+        return result;
+    }
+
+    int64_t ParseStatistics::ReductionNanoseconds() const
+    {
+        int64_t result = 0;
+        for (const auto& counter : productions)
+            result += counter.reduction_nanoseconds;
+
+        return result;
+    }
+
+    void ParseStatistics::Merge(const ParseStatistics& other)
+    {
+        shift_count += other.shift_count;
+
+        productions.resize(max(productions.size(), other.productions.size()));
+        for (int i = 0; i < other.productions.size(); ++i)
+        {
+            productions[i].reduction_count += other.productions[i].reduction_count;
+            productions[i].reduction_nanoseconds += other.productions[i].reduction_nanoseconds;
+        }
+
+        max_stack_depth = max(max_stack_depth, other.max_stack_depth);
+
+        lexed_bytes += other.lexed_bytes;
+        rescanned_bytes += other.rescanned_bytes;
+        ignored_token_count += other.ignored_token_count;
+        constructed_node_bytes += other.constructed_node_bytes;
+    }
+
+    // =====================================================================================
+    // Implementation of Hot Production Report
+    //
+
+    vector<const ProductionInfo*> RankHotProductions(const ParsingMetaInfo& info, const ParseStatistics& stats, HotProductionOrder order)
+    {
+        vector<const ProductionInfo*> result;
+        for (const auto& production : info.Productions())
+        {
+            if (production.Id() < stats.productions.size() && stats.productions[production.Id()].reduction_count > 0)
+                result.push_back(&production);
+        }
+
+        auto key = [&](const ProductionInfo* p) {
+            const auto& counter = stats.productions[p->Id()];
+            return order == HotProductionOrder::ReductionCount
+                       ? make_pair(counter.reduction_count, counter.reduction_nanoseconds)
+                       : make_pair(counter.reduction_nanoseconds, counter.reduction_count);
+        };
+
+        stable_sort(result.begin(), result.end(), [&](const ProductionInfo* lhs, const ProductionInfo* rhs) {
+            return key(lhs) > key(rhs);
+        });
+
+        return result;
+    }
+
+    void WriteHotProductionReport(ostream& output, const ParsingMetaInfo& info, const ParseStatistics& stats,
+                                  HotProductionOrder order, int max_rows)
+    {
+        const auto reduction_count = stats.ReductionCount();
+        const auto reduction_time  = stats.ReductionNanoseconds();
+
+        auto percentage = [](int64_t part, int64_t total) {
+            return total > 0 ? 100. * part / total : 0.;
+        };
+
+        output << fixed << setprecision(1);
+
+        output << "shifts: " << stats.shift_count << "\n";
+        output << "reductions: " << reduction_count << " in " << reduction_time / 1e6 << " ms\n";
+        output << "max stack depth: " << stats.max_stack_depth << "\n";
+        output << "lexed bytes: " << stats.lexed_bytes
+               << ", rescanned: " << stats.rescanned_bytes
+               << " (" << percentage(stats.rescanned_bytes, stats.lexed_bytes) << "%)\n";
+        output << "ignored tokens: " << stats.ignored_token_count << "\n";
+        output << "constructed node bytes: " << stats.constructed_node_bytes << "\n";
+        output << "\n";
+
+        output << setw(12) << "reductions" << setw(8) << "%"
+               << setw(12) << "us" << setw(8) << "%"
+               << setw(10) << "ns/each" << "  production\n";
+
+        auto ranking = RankHotProductions(info, stats, order);
+        for (int i = 0; i < ranking.size() && i < max_rows; ++i)
+        {
+            const auto& counter = stats.productions[ranking[i]->Id()];
+
+            output << setw(12) << counter.reduction_count
+                   << setw(8) << percentage(counter.reduction_count, reduction_count)
+                   << setw(12) << counter.reduction_nanoseconds / 1e3
+                   << setw(8) << percentage(counter.reduction_nanoseconds, reduction_time)
+                   << setw(10) << static_cast<double>(counter.reduction_nanoseconds) / counter.reduction_count
+                   << "  " << debug::ToString_Production(*ranking[i]) << "\n";
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include "core/parsing-info.h"
+#include "core/trace.h"
 #include <algorithm>
 #include <cassert>
 #include <sstream>
@@ -22,12 +23,28 @@ namespace eds::loli
     public:
         unique_ptr<ParsingMetaInfo> Build(const string& config, const AstTypeProxyManager* env)
         {
-            auto cc = ParseConfig(config.c_str());
+            TraceSpan span{"ResolveParsingInfo", "construction"};
+
+            unique_ptr<ParsingConfiguration> cc;
+            {
+                TraceSpan parsing_span{"ParseConfig", "construction"};
+                parsing_span.Count("bytes", config.length());
+
+                cc = ParseConfig(config.c_str());
+            }
 
             Initialize(config, env);
 
+            AugmentEntryRules(*cc);
+
             LoadTypeInfo(*cc);
             LoadSymbolInfo(*cc);
+            LoadMarkedTokenInfo(*cc);
+            LoadEntryInfo(*cc);
+
+            span.Count("tokens", site_->tokens_.Size() + site_->ignored_tokens_.Size());
+            span.Count("variables", site_->variables_.Size());
+            span.Count("productions", site_->productions_.Size());
 
             return Finalize();
         }
@@ -388,8 +405,9 @@ namespace eds::loli
 
                 for (const auto& rule_item : rule_def.items)
                 {
-                    auto& info = productions[pd_index++];
+                    auto& info = productions[pd_index];
 
+                    info.id_  = pd_index++;
                     info.lhs_ = lhs;
                     for (const auto& symbol_name : rule_item.rhs)
                     {
@@ -397,6 +415,7 @@ namespace eds::loli
                     }
 
                     info.handle_ = ConstructAstHandle(lhs->type_, rule_item);
+                    info.action_ = rule_item.action;
 
                     // inject ProductionInfo back into VariableInfo
                     lhs->productions_.push_back(&info);
@@ -404,9 +423,260 @@ namespace eds::loli
             }
         }
 
+        void LoadMarkedTokenInfo(const ParsingConfiguration& config)
+        {
+            const auto& symbol_lookup = site_->symbol_lookup_;
+
+            auto lookup_token = [&](const string& name) -> const TokenInfo* {
+                auto iter = symbol_lookup.find(name);
+                return iter != symbol_lookup.end() ? dynamic_cast<const TokenInfo*>(iter->second) : nullptr;
+            };
+
+            for (const auto& name : config.sync_tokens)
+            {
+                auto token = lookup_token(name);
+
+                Assert(token != nullptr, "ParsingMetaInfoBuilder: sync token must be a declared token");
+                site_->sync_tokens_.push_back(token);
+            }
+
+            for (const auto& name : config.split_tokens)
+            {
+                auto token = lookup_token(name);
+
+                Assert(token != nullptr, "ParsingMetaInfoBuilder: split token must be a declared token");
+                site_->split_tokens_.push_back(token);
+            }
+        }
+
+        string MarkerName(const string& entry)
+        {
+            return "#marker-" + entry;
+        }
+        string AugmentedName(const string& entry)
+        {
+            return "#entry-" + entry;
+        }
+
+        // synthesize rules for entries right before the root so that it's still the last variable,
+        // see ParsingMetaInfo::EntryInfo
+        // NOTE names of synthesized variables never clash with identifiers of the grammar
+        void AugmentEntryRules(ParsingConfiguration& config)
+        {
+            if (config.entries.empty())
+                return;
+
+            Assert(!config.rules.empty(), "ParsingMetaInfoBuilder: entry declared without any rule");
+
+            auto augmented_rules = vector<RuleDefinition>{};
+            for (const auto& name : config.entries)
+            {
+                auto pred = [&](const RuleDefinition& rule) { return rule.name == name; };
+                auto it   = find_if(config.rules.begin(), config.rules.end(), pred);
+
+                Assert(it != config.rules.end(), "ParsingMetaInfoBuilder: entry must be a declared variable");
+
+                // root is always a start symbol
+                if (next(it) == config.rules.end())
+                    continue;
+
+                auto marker_rule    = RuleDefinition{it->type, MarkerName(name), {}};
+                auto augmented_rule = RuleDefinition{it->type, AugmentedName(name), {}};
+                augmented_rule.items.push_back(
+                    RuleItem{{RuleSymbol{MarkerName(name), ""}, RuleSymbol{name, "!"}}, nullopt, ""});
+
+                augmented_rules.push_back(move(marker_rule));
+                augmented_rules.push_back(move(augmented_rule));
+            }
+
+            config.rules.insert(prev(config.rules.end()), augmented_rules.begin(), augmented_rules.end());
+        }
+
+        void LoadEntryInfo(const ParsingConfiguration& config)
+        {
+            const auto& symbol_lookup = site_->symbol_lookup_;
+
+            auto lookup_variable = [&](const string& name) {
+                return dynamic_cast<const VariableInfo*>(symbol_lookup.at(name));
+            };
+
+            for (const auto& name : config.entries)
+            {
+                // skip root, see AugmentEntryRules
+                // NOTE a duplicate entry has been rejected as a duplicate symbol
+                if (symbol_lookup.count(AugmentedName(name)) == 0)
+                    continue;
+
+                site_->entries_.push_back(
+                    ParsingMetaInfo::EntryInfo{lookup_variable(name), lookup_variable(MarkerName(name)), lookup_variable(AugmentedName(name))});
+            }
+        }
+
         unique_ptr<ParsingMetaInfo> site_;
     };
 
+    const ParsingMetaInfo::EntryInfo* ParsingMetaInfo::LookupEntry(const string& name) const
+    {
+        for (const auto& entry : entries_)
+        {
+            if (entry.variable->Name() == name)
+                return &entry;
+        }
+
+        return nullptr;
+    }
+
+    // =====================================================================================
+    // Implementation of Memory Footprint
+    //
+
+    namespace
+    {
+        // bytes of a string beyond the object itself, which are none if it's stored inline
+        size_t StringHeapBytes(const string& s)
+        {
+            auto data  = reinterpret_cast<const char*>(s.data());
+            auto begin = reinterpret_cast<const char*>(&s);
+            if (data >= begin && data < begin + sizeof(s))
+                return 0;
+
+            return s.capacity() + 1;
+        }
+
+        template <typename T>
+        size_t VectorHeapBytes(const vector<T>& v)
+        {
+            return v.capacity() * sizeof(T);
+        }
+
+        // NOTE a node of a hash map is approximated as the value plus a pointer to the next one
+        template <typename Map>
+        size_t MapHeapBytes(const Map& map)
+        {
+            size_t result = map.bucket_count() * sizeof(void*) + map.size() * (sizeof(typename Map::value_type) + sizeof(void*));
+            for (const auto& pair : map)
+                result += StringHeapBytes(pair.first);
+
+            return result;
+        }
+
+        class RegexFootprintVisitor : public RegexExprVisitor
+        {
+        public:
+            size_t result = 0;
+
+            void Visit(const RootExpr& expr) override
+            {
+                result += sizeof(RootExpr);
+                expr.Child()->Accept(*this);
+            }
+            void Visit(const EntityExpr& expr) override
+            {
+                result += sizeof(EntityExpr);
+            }
+            void Visit(const SequenceExpr& expr) override
+            {
+                result += sizeof(SequenceExpr) + VectorHeapBytes(expr.Children());
+                for (const auto& child : expr.Children())
+                    child->Accept(*this);
+            }
+            void Visit(const ChoiceExpr& expr) override
+            {
+                result += sizeof(ChoiceExpr) + VectorHeapBytes(expr.Children());
+                for (const auto& child : expr.Children())
+                    child->Accept(*this);
+            }
+            void Visit(const ClosureExpr& expr) override
+            {
+                result += sizeof(ClosureExpr);
+                expr.Child()->Accept(*this);
+            }
+        };
+
+        size_t HandleHeapBytes(const AstHandle& handle)
+        {
+            struct Visitor
+            {
+                size_t operator()(const AstManipPlaceholder&) { return 0; }
+                size_t operator()(const AstObjectSetter& manip) { return VectorHeapBytes(manip.Setters()); }
+                size_t operator()(const AstVectorMerger& manip) { return VectorHeapBytes(manip.Indices()); }
+            };
+
+            return sizeof(AstHandle) + visit(Visitor{}, handle.Manipulator());
+        }
+    }
+
+    size_t ParsingMetaInfo::MemoryFootprint() const
+    {
+        size_t result = sizeof(ParsingMetaInfo);
+
+        // types
+        result += MapHeapBytes(type_lookup_);
+        result += enums_.Size() * sizeof(EnumTypeInfo) + bases_.Size() * sizeof(BaseTypeInfo) + klasses_.Size() * sizeof(KlassTypeInfo);
+        for (const auto& type : enums_)
+        {
+            result += StringHeapBytes(type.Name()) + VectorHeapBytes(type.Values());
+            for (const auto& value : type.Values())
+                result += StringHeapBytes(value);
+        }
+        for (const auto& type : bases_)
+        {
+            result += StringHeapBytes(type.Name());
+        }
+        for (const auto& type : klasses_)
+        {
+            result += StringHeapBytes(type.Name()) + VectorHeapBytes(type.Members());
+            for (const auto& member : type.Members())
+                result += StringHeapBytes(member.name);
+        }
+
+        // symbols
+        result += MapHeapBytes(symbol_lookup_);
+        result += (tokens_.Size() + ignored_tokens_.Size()) * sizeof(TokenInfo) + variables_.Size() * sizeof(VariableInfo);
+        for (const auto* tokens : {&tokens_, &ignored_tokens_})
+        {
+            for (const auto& token : *tokens)
+            {
+                RegexFootprintVisitor visitor;
+                if (token.TreeDefinition())
+                    token.TreeDefinition()->Accept(visitor);
+
+                result += StringHeapBytes(token.Name()) + StringHeapBytes(token.TextDefinition()) + visitor.result;
+            }
+        }
+        for (const auto& variable : variables_)
+        {
+            result += StringHeapBytes(variable.Name()) + VectorHeapBytes(variable.Productions());
+        }
+
+        // productions
+        result += productions_.Size() * sizeof(ProductionInfo);
+        for (const auto& production : productions_)
+        {
+            result += VectorHeapBytes(production.Right()) + StringHeapBytes(production.Action());
+            if (production.Handle())
+                result += HandleHeapBytes(*production.Handle());
+        }
+
+        result += VectorHeapBytes(sync_tokens_) + VectorHeapBytes(split_tokens_) + VectorHeapBytes(entries_);
+
+        return result;
+    }
+
+    void ParsingMetaInfo::ReleaseConstructionData()
+    {
+        for (auto* tokens : {&tokens_, &ignored_tokens_})
+        {
+            for (auto& token : *tokens)
+            {
+                token.ast_def_ = nullptr;
+                string{}.swap(token.text_def_);
+            }
+        }
+
+        SymbolInfoMap{}.swap(symbol_lookup_);
+    }
+
     std::unique_ptr<ParsingMetaInfo> ResolveParsingInfo(const string& config, const AstTypeProxyManager* env)
     {
         ParsingMetaInfo::Builder builder{};
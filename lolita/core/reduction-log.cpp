@@ -0,0 +1,168 @@
+#include "core/reduction-log.h"
+#include <algorithm>
+
+using namespace std;
+using namespace eds::loli::ast;
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // Implementation of LazyAstNode
+    //
+
+    bool LazyAstNode::IsToken() const
+    {
+        return log_->IsShift(index_);
+    }
+
+    const ProductionInfo* LazyAstNode::Production() const
+    {
+        return log_->At(index_).production;
+    }
+    const VariableInfo* LazyAstNode::Variable() const
+    {
+        auto production = Production();
+        return production ? production->Left() : nullptr;
+    }
+
+    AstLocationInfo LazyAstNode::GetLocationInfo() const
+    {
+        const auto& entry = log_->At(index_);
+        return AstLocationInfo{entry.offset, entry.length};
+    }
+
+    vector<LazyAstNode> LazyAstNode::Children() const
+    {
+        vector<LazyAstNode> result;
+        if (IsToken())
+            return result;
+
+        // walk backward as each child ends right before its next sibling
+        const auto count = Production()->Right().size();
+        for (int i = 0, child = index_ - 1; i < count; ++i)
+        {
+            assert(child >= 0);
+
+            result.push_back(LazyAstNode{log_, child});
+            child = log_->SubtreeBegin(child) - 1;
+        }
+
+        reverse(result.begin(), result.end());
+        return result;
+    }
+    LazyAstNode LazyAstNode::Child(int index) const
+    {
+        return Children().at(index);
+    }
+
+    AstItemWrapper LazyAstNode::Materialize(Arena& arena) const
+    {
+        return log_->Materialize(arena, index_);
+    }
+
+    // =====================================================================================
+    // Implementation of ReductionLog
+    //
+
+    int ReductionLog::RecordShift(const BasicAstToken& tok)
+    {
+        assert(tok.IsValid());
+
+        entries_.push_back(Entry{nullptr, tok.Tag(), tok.Offset(), tok.Length()});
+        return Size() - 1;
+    }
+
+    int ReductionLog::RecordReduce(const ProductionInfo& production, ArrayRef<int> children)
+    {
+        assert(children.Length() == production.Right().size());
+
+        const auto index = Size();
+        const auto begin = children.Length() == 0 ? index : SubtreeBegin(children.Front());
+
+        // a selected value is modified by this production, at least its location
+        if (auto selector = get_if<AstItemSelector>(&production.Handle()->Generator()); selector)
+        {
+            entries_[children.At(selector->Index())].selected = true;
+        }
+
+        auto location = CombineLocationInfo(children.Length(), [&](int i) {
+            const auto& child = At(children.At(i));
+            return AstLocationInfo{child.offset, child.length};
+        });
+
+        entries_.push_back(Entry{&production, begin, location.offset, location.length});
+
+        return index;
+    }
+
+    AstItemWrapper ReductionLog::Materialize(Arena& arena, int index)
+    {
+        const auto& root = At(index);
+        if (IsShift(index))
+        {
+            return BasicAstToken{root.offset, root.length, root.value};
+        }
+
+        // cached subtrees are only valid in the arena they live in
+        if (materialized_arena_ != &arena)
+        {
+            materialized_.clear();
+            materialized_arena_ = &arena;
+        }
+
+        // replay the subtree in post-order just like how ParsingContext does,
+        // where subtrees materialized before are reused rather than built again
+        // NOTE a node is pushed once to expand its children and once more to reduce them
+        vector<pair<int, bool>> to_be_visited = {{index, false}};
+        vector<AstItemWrapper> ast_stack;
+        while (!to_be_visited.empty())
+        {
+            auto [i, expanded] = to_be_visited.back();
+            to_be_visited.pop_back();
+
+            const auto& entry = entries_[i];
+            if (entry.production == nullptr)
+            {
+                ast_stack.push_back(BasicAstToken{entry.offset, entry.length, entry.value});
+            }
+            else if (auto it = materialized_.find(i); it != materialized_.end())
+            {
+                ast_stack.push_back(it->second);
+            }
+            else if (!expanded)
+            {
+                to_be_visited.push_back({i, true});
+
+                // walk backward as each child ends right before its next sibling,
+                // so that the first child is visited first
+                const auto count = entry.production->Right().size();
+                for (int k = 0, child = i - 1; k < count; ++k)
+                {
+                    to_be_visited.push_back({child, false});
+                    child = SubtreeBegin(child) - 1;
+                }
+            }
+            else
+            {
+                const auto count = entry.production->Right().size();
+
+                auto ref    = ArrayRef<AstItemWrapper>(ast_stack.data(), ast_stack.size()).TakeBack(count);
+                auto result = entry.production->Handle()->Invoke(arena, ref);
+
+                for (auto j = 0; j < count; ++j)
+                    ast_stack.pop_back();
+
+                ast_stack.push_back(result);
+
+                // a selected value is to be modified by the parent, so it's built again next time
+                if (!entry.selected)
+                {
+                    materialized_[i] = result;
+                }
+            }
+        }
+
+        assert(ast_stack.size() == 1);
+        return ast_stack.back();
+    }
+}
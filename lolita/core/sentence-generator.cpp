@@ -0,0 +1,433 @@
+#include "core/sentence-generator.h"
+#include "lexing/lexing-automaton.h"
+#include <numeric>
+#include <unordered_set>
+
+using namespace std;
+using namespace eds::loli::regex;
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // Regex Sampling
+    //
+
+    // render a random string matched by a regex, where repetitions are kept short
+    class RegexSampler : public RegexExprVisitor
+    {
+    public:
+        RegexSampler(mt19937_64& random)
+            : random_(random) {}
+
+        string Sample(const RootExpr& expr)
+        {
+            result_.clear();
+            expr.Accept(*this);
+
+            return result_;
+        }
+
+        void Visit(const RootExpr& expr) override
+        {
+            expr.Child()->Accept(*this);
+        }
+        void Visit(const EntityExpr& expr) override
+        {
+            // prefer printable characters that the lexer accepts
+            auto range = expr.Range();
+            auto first = max(range.Min(), 1);
+            auto last  = min(range.Max(), 127);
+            if (first <= 126 && last >= 32)
+            {
+                first = max(first, 32);
+                last  = min(last, 126);
+            }
+
+            result_.push_back(static_cast<char>(Between(first, last)));
+        }
+        void Visit(const SequenceExpr& expr) override
+        {
+            for (const auto& child : expr.Children())
+                child->Accept(*this);
+        }
+        void Visit(const ChoiceExpr& expr) override
+        {
+            const auto& children = expr.Children();
+            children[Between(0, children.size() - 1)]->Accept(*this);
+        }
+        void Visit(const ClosureExpr& expr) override
+        {
+            auto count = 0;
+            switch (expr.Mode())
+            {
+            case RepetitionMode::Optional:
+                count = Between(0, 1);
+                break;
+            case RepetitionMode::Star:
+                count = Between(0, 3);
+                break;
+            case RepetitionMode::Plus:
+                count = Between(1, 3);
+                break;
+            }
+
+            for (int i = 0; i < count; ++i)
+                expr.Child()->Accept(*this);
+        }
+
+    private:
+        int Between(int min, int max)
+        {
+            return uniform_int_distribution<int>{min, max}(random_);
+        }
+
+        mt19937_64& random_;
+        string result_ = {};
+    };
+
+    // =====================================================================================
+    // Implementation of SentenceGenerator
+    //
+
+    SentenceGenerator::SentenceGenerator(const ParsingMetaInfo& info, Options options)
+        : info_(info), options_(options), random_(options.seed)
+    {
+        for (const auto* tokens : {&info_.Tokens(), &info_.IgnoredTokens()})
+        {
+            for (const auto& token : *tokens)
+            {
+                if (!token.TreeDefinition())
+                    throw ParserInternalError{"SentenceGenerator: regex trees of tokens are released"};
+            }
+        }
+
+        LoadSamples();
+        ComputeCosts();
+    }
+
+    void SentenceGenerator::Generate(string& output, const VariableInfo& variable, size_t size)
+    {
+        if (variable_costs_[variable.Id()] >= kInfiniteCost)
+            throw ParserInternalError{"SentenceGenerator: variable derives no renderable sentence"};
+
+        stack_.clear();
+        stack_.push_back(Pending{&variable, output.size() + size, 0, false, false, -1});
+
+        while (!stack_.empty())
+        {
+            auto pending = stack_.back();
+            stack_.pop_back();
+
+            if (auto token = pending.symbol->AsToken(); token)
+                Emit(output, *token);
+            else if (pending.list_tail)
+                ExpandTail(output, pending);
+            else
+                Expand(output, pending);
+        }
+    }
+
+    void SentenceGenerator::LoadSamples()
+    {
+        static constexpr int kSampleCount  = 8;
+        static constexpr int kAttemptCount = 64;
+
+        auto dfa     = lexing::BuildLexingAutomaton(info_);
+        auto sampler = RegexSampler{random_};
+
+        // token the lexer reads from the whole text in one piece, nullptr if none
+        auto read_back = [&](const string& text) -> const TokenInfo* {
+            auto state = dfa->LookupState(0);
+            for (auto ch : text)
+            {
+                auto iter = state->transitions.find(ch);
+                if (iter == state->transitions.end())
+                    return nullptr;
+
+                state = iter->second;
+            }
+
+            return state->acc_token;
+        };
+
+        auto load = [&](const TokenInfo& token) {
+            auto samples = vector<string>{};
+            for (int i = 0; i < kAttemptCount && samples.size() < kSampleCount; ++i)
+            {
+                auto text = sampler.Sample(*token.TreeDefinition());
+                if (!text.empty() && read_back(text) == &token &&
+                    find(samples.begin(), samples.end(), text) == samples.end())
+                {
+                    samples.push_back(move(text));
+                }
+            }
+
+            return samples;
+        };
+
+        for (const auto& token : info_.Tokens())
+        {
+            token_samples_.push_back(load(token));
+        }
+        for (const auto& token : info_.IgnoredTokens())
+        {
+            auto samples = load(token);
+            separator_samples_.insert(separator_samples_.end(), samples.begin(), samples.end());
+        }
+    }
+
+    void SentenceGenerator::ComputeCosts()
+    {
+        auto average_length = [](const vector<string>& samples) -> size_t {
+            auto total = accumulate(samples.begin(), samples.end(), size_t{0},
+                                    [](size_t sum, const string& s) { return sum + s.length(); });
+
+            return samples.empty() ? 0 : total / samples.size();
+        };
+
+        // tokens
+        const auto separator_cost = average_length(separator_samples_);
+        for (const auto& samples : token_samples_)
+        {
+            token_costs_.push_back(samples.empty() ? kInfiniteCost : average_length(samples) + separator_cost);
+        }
+
+        // variables, iterated until neither costs nor heights decrease
+        variable_costs_.assign(info_.Variables().Size(), kInfiniteCost);
+        variable_heights_.assign(info_.Variables().Size(), kInfiniteHeight);
+        for (auto updated = true; updated;)
+        {
+            updated = false;
+
+            for (const auto& production : info_.Productions())
+            {
+                const auto id     = production.Left()->Id();
+                const auto cost   = CostOf(production.Right(), 0, production.Right().size());
+                const auto height = HeightOf(&production);
+
+                if (cost < variable_costs_[id])
+                {
+                    variable_costs_[id] = cost;
+                    updated             = true;
+                }
+                if (height < variable_heights_[id])
+                {
+                    variable_heights_[id] = height;
+                    updated               = true;
+                }
+            }
+        }
+
+        // shapes
+        shapes_.resize(info_.Variables().Size());
+        for (const auto& production : info_.Productions())
+        {
+            const auto& rhs = production.Right();
+            auto& shape     = shapes_[production.Left()->Id()];
+
+            if (!rhs.empty() && rhs.front() == production.Left())
+                shape.left_recursive.push_back(&production);
+            else if (!rhs.empty() && rhs.back() == production.Left())
+                shape.right_recursive.push_back(&production);
+            else
+                shape.others.push_back(&production);
+        }
+    }
+
+    void SentenceGenerator::Emit(string& output, const TokenInfo& token)
+    {
+        const auto& samples = token_samples_[token.Id()];
+        assert(!samples.empty());
+
+        if (!output.empty() && !separator_samples_.empty())
+        {
+            output.append(separator_samples_[RandomBetween(0, separator_samples_.size() - 1)]);
+        }
+
+        output.append(samples[RandomBetween(0, samples.size() - 1)]);
+    }
+
+    void SentenceGenerator::Expand(string& output, const Pending& pending)
+    {
+        const auto& variable = *pending.symbol->AsVariable();
+        const auto& shape    = shapes_[variable.Id()];
+
+        const auto begin  = output.size();
+        const auto budget = pending.end > begin ? pending.end - begin : 0;
+
+        // cut short
+        if (pending.depth >= options_.max_depth || budget <= variable_costs_[variable.Id()])
+        {
+            const auto& rhs = ShortestProduction(variable)->Right();
+            PushSequence(rhs, 0, rhs.size(), begin, 0, pending.depth + 1);
+        }
+        // a list growing to the right of its head
+        else if (!shape.left_recursive.empty() && !shape.others.empty())
+        {
+            stack_.push_back(Pending{&variable, pending.end, pending.depth, true, true, -1});
+
+            auto head_cost = kInfiniteCost;
+            for (auto production : shape.others)
+            {
+                head_cost = min(head_cost, CostOf(production->Right(), 0, production->Right().size()));
+            }
+
+            const auto share = ElementShare(min(head_cost, budget), budget);
+            auto head        = RandomProduction(shape.others, share);
+            if (head == nullptr)
+                head = ShortestProduction(variable);
+
+            PushSequence(head->Right(), 0, head->Right().size(), begin, share, pending.depth + 1);
+        }
+        // a list growing to the left of its end
+        else if (!shape.right_recursive.empty())
+        {
+            stack_.push_back(Pending{&variable, pending.end, pending.depth, true, false, -1});
+        }
+        else
+        {
+            auto production = RandomProduction(shape.others, budget);
+            if (production == nullptr)
+                production = ShortestProduction(variable);
+
+            PushSequence(production->Right(), 0, production->Right().size(), begin, budget, pending.depth + 1);
+        }
+    }
+
+    void SentenceGenerator::ExpandTail(string& output, const Pending& pending)
+    {
+        const auto& variable = *pending.symbol->AsVariable();
+        const auto& shape    = shapes_[variable.Id()];
+
+        const auto begin  = output.size();
+        const auto budget = pending.end > begin ? pending.end - begin : 0;
+
+        // a list stops growing once its budget is used up or an element turns out to be empty
+        const auto growing = budget > 0 && static_cast<int64_t>(begin) > pending.mark;
+
+        const auto& candidates = pending.left_recursive ? shape.left_recursive : shape.right_recursive;
+        if (growing)
+        {
+            const auto production = candidates[RandomBetween(0, candidates.size() - 1)];
+            const auto& rhs       = production->Right();
+
+            // element of the list, excluding the variable itself
+            const auto first = pending.left_recursive ? 1 : 0;
+            const auto last  = pending.left_recursive ? rhs.size() : rhs.size() - 1;
+            const auto share = ElementShare(min(CostOf(rhs, first, last), budget), budget);
+
+            stack_.push_back(Pending{&variable, pending.end, pending.depth, true, pending.left_recursive, static_cast<int64_t>(begin)});
+            PushSequence(rhs, first, last, begin, share, pending.depth + 1);
+        }
+        else if (!pending.left_recursive)
+        {
+            // end of the list
+            auto production = RandomProduction(shape.others, budget);
+            if (production == nullptr)
+                production = ShortestProduction(variable);
+
+            PushSequence(production->Right(), 0, production->Right().size(), begin, budget, pending.depth + 1);
+        }
+    }
+
+    void SentenceGenerator::PushSequence(const vector<SymbolInfo*>& symbols, int first, int last, size_t begin, size_t budget, int depth)
+    {
+        // extra budget goes to variables in random proportion
+        const auto min_cost = CostOf(symbols, first, last);
+        const auto excess   = budget > min_cost ? budget - min_cost : 0;
+
+        auto weights = vector<double>(last - first, 0.);
+        for (int i = first; i < last; ++i)
+        {
+            if (symbols[i]->IsVariable())
+                weights[i - first] = uniform_real_distribution<double>{0., 1.}(random_);
+        }
+
+        const auto weight_sum = accumulate(weights.begin(), weights.end(), 0.);
+
+        auto ends = vector<size_t>(last - first, 0);
+        auto end  = begin;
+        for (int i = first; i < last; ++i)
+        {
+            end += CostOf(symbols[i]);
+            if (weight_sum > 0)
+                end += static_cast<size_t>(excess * weights[i - first] / weight_sum);
+
+            ends[i - first] = end;
+        }
+
+        for (int i = last - 1; i >= first; --i)
+        {
+            stack_.push_back(Pending{symbols[i], ends[i - first], depth, false, false, -1});
+        }
+    }
+
+    const ProductionInfo* SentenceGenerator::ShortestProduction(const VariableInfo& variable) const
+    {
+        const ProductionInfo* result = nullptr;
+        for (auto production : variable.Productions())
+        {
+            if (result == nullptr || HeightOf(production) < HeightOf(result))
+                result = production;
+        }
+
+        if (result == nullptr || HeightOf(result) >= kInfiniteHeight)
+            throw ParserInternalError{"SentenceGenerator: variable derives no renderable sentence"};
+
+        return result;
+    }
+
+    const ProductionInfo* SentenceGenerator::RandomProduction(const vector<const ProductionInfo*>& candidates, size_t budget)
+    {
+        auto fitting = vector<const ProductionInfo*>{};
+        for (auto production : candidates)
+        {
+            if (CostOf(production->Right(), 0, production->Right().size()) <= budget)
+                fitting.push_back(production);
+        }
+
+        return fitting.empty() ? nullptr : fitting[RandomBetween(0, fitting.size() - 1)];
+    }
+
+    size_t SentenceGenerator::CostOf(const SymbolInfo* symbol) const
+    {
+        if (auto token = symbol->AsToken(); token)
+            return token_costs_[token->Id()];
+        else
+            return variable_costs_[symbol->AsVariable()->Id()];
+    }
+
+    size_t SentenceGenerator::CostOf(const vector<SymbolInfo*>& symbols, int first, int last) const
+    {
+        size_t result = 0;
+        for (int i = first; i < last; ++i)
+        {
+            result = min(result + CostOf(symbols[i]), kInfiniteCost);
+        }
+
+        return result;
+    }
+
+    int SentenceGenerator::HeightOf(const ProductionInfo* production) const
+    {
+        auto result = 0;
+        for (auto symbol : production->Right())
+        {
+            if (auto token = symbol->AsToken(); token)
+            {
+                if (token_samples_[token->Id()].empty())
+                    return kInfiniteHeight;
+            }
+            else
+            {
+                auto height = variable_heights_[symbol->AsVariable()->Id()];
+                if (height >= kInfiniteHeight)
+                    return kInfiniteHeight;
+
+                result = max(result, height);
+            }
+        }
+
+        return result + 1;
+    }
+}
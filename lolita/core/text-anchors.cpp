@@ -0,0 +1,119 @@
+#include "core/text-anchors.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // Implementation of TextAnchors
+    //
+
+    void TextAnchors::Reset(int length)
+    {
+        assert(length >= 0);
+
+        pieces_.clear();
+        if (length > 0)
+        {
+            pieces_.push_back(Piece{0, 0, length});
+        }
+
+        anchor_order_ = pieces_;
+        next_anchor_  = length;
+    }
+
+    void TextAnchors::Replace(int offset, int removed_length, int inserted_length)
+    {
+        assert(offset >= 0 && removed_length >= 0 && inserted_length >= 0);
+
+        const auto removed_end = offset + removed_length;
+        const auto delta       = inserted_length - removed_length;
+
+        auto result = vector<Piece>{};
+        auto append = [&](Piece piece) {
+            if (piece.length == 0)
+                return;
+
+            // merge with the preceding piece if anchors run on, e.g. characters typed one by one
+            if (!result.empty())
+            {
+                auto& last = result.back();
+                if (last.offset + last.length == piece.offset && last.anchor + last.length == piece.anchor)
+                {
+                    last.length += piece.length;
+                    return;
+                }
+            }
+
+            result.push_back(piece);
+        };
+
+        auto inserted = false;
+        auto insert   = [&]() {
+            if (!inserted)
+            {
+                append(Piece{offset, next_anchor_, inserted_length});
+                next_anchor_ += inserted_length;
+                inserted = true;
+            }
+        };
+
+        for (const auto& piece : pieces_)
+        {
+            const auto piece_end = piece.offset + piece.length;
+
+            // characters before the edit
+            if (piece.offset < offset)
+            {
+                append(Piece{piece.offset, piece.anchor, min(piece_end, offset) - piece.offset});
+            }
+
+            // characters after the edit, which are moved by delta
+            if (piece_end > removed_end)
+            {
+                insert();
+
+                const auto begin = max(piece.offset, removed_end);
+                append(Piece{begin + delta, piece.anchor + (begin - piece.offset), piece_end - begin});
+            }
+        }
+
+        insert();
+
+        pieces_       = move(result);
+        anchor_order_ = pieces_;
+        sort(anchor_order_.begin(), anchor_order_.end(), [](const Piece& lhs, const Piece& rhs) {
+            return lhs.anchor < rhs.anchor;
+        });
+    }
+
+    int TextAnchors::ToAnchor(int offset) const
+    {
+        auto it = upper_bound(pieces_.begin(), pieces_.end(), offset, [](int value, const Piece& piece) {
+            return value < piece.offset;
+        });
+
+        assert(it != pieces_.begin());
+        --it;
+
+        assert(offset < it->offset + it->length);
+        return it->anchor + (offset - it->offset);
+    }
+
+    int TextAnchors::ToOffset(int anchor) const
+    {
+        auto it = upper_bound(anchor_order_.begin(), anchor_order_.end(), anchor, [](int value, const Piece& piece) {
+            return value < piece.anchor;
+        });
+
+        if (it == anchor_order_.begin())
+            return -1;
+
+        --it;
+        if (anchor >= it->anchor + it->length)
+            return -1;
+
+        return it->offset + (anchor - it->anchor);
+    }
+}
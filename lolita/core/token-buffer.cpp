@@ -0,0 +1,81 @@
+#include "core/token-buffer.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // Implementation of TokenBuffer
+    //
+
+    void TokenBuffer::Reset(bool valid)
+    {
+        valid_ = valid;
+        entries_.clear();
+
+        shift_begin_ = 0;
+        shift_delta_ = 0;
+    }
+
+    int TokenBuffer::FindAffected(int offset) const
+    {
+        // scan_end is a running maximum, thus non-decreasing
+        int lo = 0, hi = Size();
+        while (lo < hi)
+        {
+            auto mid = lo + (hi - lo) / 2;
+            if (ScanEndOf(mid) > offset)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+
+        return lo;
+    }
+
+    void TokenBuffer::Splice(int first, int last, const vector<Entry>& replacement, int delta, int scan_end)
+    {
+        assert(first >= 0 && first <= last && last <= Size());
+
+        // pending shift now starts right at the tail, which is moved further by delta
+        MoveShiftBoundary(last);
+        shift_delta_ += delta;
+
+        // replace tokens in [first, last)
+        const auto count = static_cast<int>(replacement.size());
+        if (count < last - first)
+        {
+            entries_.erase(entries_.begin() + first + count, entries_.begin() + last);
+        }
+        else if (count > last - first)
+        {
+            entries_.insert(entries_.begin() + last, count - (last - first), Entry{});
+        }
+
+        copy(replacement.begin(), replacement.end(), entries_.begin() + first);
+        shift_begin_ = first + count;
+
+        // keep scan_end a running maximum, as lookahead of relexing may run into the tail
+        for (int i = shift_begin_; i < Size() && ScanEndOf(i) < scan_end; ++i)
+        {
+            entries_[i].scan_end = scan_end - shift_delta_;
+        }
+    }
+
+    void TokenBuffer::MoveShiftBoundary(int index)
+    {
+        if (shift_delta_ != 0)
+        {
+            // tokens in between switch between shifted and not shifted
+            const auto sign = index > shift_begin_ ? 1 : -1;
+            for (int i = min(index, shift_begin_); i < max(index, shift_begin_); ++i)
+            {
+                entries_[i].offset += sign * shift_delta_;
+                entries_[i].scan_end += sign * shift_delta_;
+            }
+        }
+
+        shift_begin_ = index;
+    }
+}
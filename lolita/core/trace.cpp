@@ -0,0 +1,76 @@
+#include "core/trace.h"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+
+using namespace std;
+
+namespace eds::loli
+{
+    namespace
+    {
+        atomic<Tracer*> installed_tracer{nullptr};
+    }
+
+    void InstallTracer(Tracer* tracer)
+    {
+        installed_tracer.store(tracer, memory_order_release);
+    }
+
+    Tracer* InstalledTracer()
+    {
+        return installed_tracer.load(memory_order_acquire);
+    }
+
+    // =====================================================================================
+    // Implementation of Tracer
+    //
+
+    void Tracer::Record(TraceEvent event)
+    {
+        lock_guard<mutex> lock{mutex_};
+
+        auto id   = this_thread::get_id();
+        auto iter = find(threads_.begin(), threads_.end(), id);
+        if (iter == threads_.end())
+            iter = threads_.insert(threads_.end(), id);
+
+        event.thread_id = static_cast<int>(iter - threads_.begin()) + 1;
+        events_.push_back(move(event));
+    }
+
+    vector<TraceEvent> Tracer::Events() const
+    {
+        lock_guard<mutex> lock{mutex_};
+
+        return events_;
+    }
+
+    void Tracer::WriteChromeTrace(ostream& output) const
+    {
+        auto events = Events();
+
+        // NOTE names of events and counters are identifiers in code, which need no escaping
+        output << fixed << setprecision(3);
+        output << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+        for (int i = 0; i < events.size(); ++i)
+        {
+            const auto& event = events[i];
+
+            output << (i > 0 ? ",\n" : "\n");
+            output << "    {\"name\": \"" << event.name << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\""
+                   << ", \"ts\": " << event.start_us << ", \"dur\": " << event.duration_us
+                   << ", \"pid\": 1, \"tid\": " << event.thread_id << ", \"args\": {";
+
+            for (int k = 0; k < event.counters.size(); ++k)
+            {
+                output << (k > 0 ? ", " : "") << "\"" << event.counters[k].first << "\": " << event.counters[k].second;
+            }
+
+            output << "}}";
+        }
+
+        output << "\n]}\n";
+    }
+}
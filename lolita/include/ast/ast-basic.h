@@ -20,6 +20,26 @@ namespace eds::loli::ast
         int length;
     };
 
+    // location covered by a sequence of child_count children, where child_location(i) yields that of the i-th one
+    // NOTE children of negative offset, e.g. empty lists or optionals, cover nothing, neither does a sequence of only them
+    template <typename F>
+    inline AstLocationInfo CombineLocationInfo(int child_count, F child_location)
+    {
+        auto front = 0;
+        auto back  = child_count - 1;
+        while (front < child_count && child_location(front).offset < 0)
+            front += 1;
+        while (back >= 0 && child_location(back).offset < 0)
+            back -= 1;
+
+        if (front > back)
+            return AstLocationInfo{-1, -1};
+
+        const auto front_loc = child_location(front);
+        const auto back_loc  = child_location(back);
+        return AstLocationInfo{front_loc.offset, back_loc.offset + back_loc.length - front_loc.offset};
+    }
+
     // any node in the syntax tree shoule inherit from AstNodeBase
     // to privide with offset and other basic utilities
     class AstNodeBase
@@ -153,6 +173,11 @@ namespace eds::loli::ast
             container_.push_back(value);
         }
 
+        void Reserve(int capacity)
+        {
+            container_.reserve(capacity);
+        }
+
     private:
         std::vector<T> container_;
     };
@@ -172,7 +197,7 @@ namespace eds::loli::ast
 
         bool HasValue() const
         {
-            return value.IsValid();
+            return value_.IsValid();
         }
 
         const auto& Value() const
@@ -0,0 +1,120 @@
+#pragma once
+#include "ast/ast-basic.h"
+#include <string_view>
+#include <functional>
+
+namespace eds::loli::ast
+{
+    // =====================================================================================
+    // Structural Comparer
+    //
+
+    // Structural hashing and equality of AstItems, where
+    // - tokens are compared by tag and text
+    // - enums are compared by value
+    // - objects are compared by identity, which is sound if children are interned beforehand
+    // - vectors and optionals are compared element-wise
+    //
+    // NOTE location information is always ignored
+    class AstItemComparer
+    {
+    public:
+        AstItemComparer(std::string_view source)
+            : source_(source) {}
+
+        // hashing
+        //
+
+        size_t Hash(const BasicAstToken& tok) const
+        {
+            return Combine(std::hash<int>{}(tok.Tag()), std::hash<std::string_view>{}(TextOf(tok)));
+        }
+
+        template <typename EnumType>
+        size_t Hash(const BasicAstEnum<EnumType>& e) const
+        {
+            return std::hash<int>{}(e.IntValue());
+        }
+
+        template <typename T>
+        size_t Hash(T* obj) const
+        {
+            return std::hash<const void*>{}(obj);
+        }
+
+        template <typename T>
+        size_t Hash(AstVector<T>* vec) const
+        {
+            size_t result = std::hash<int>{}(vec->Size());
+            for (const auto& elem : vec->Value())
+            {
+                result = Combine(result, Hash(elem));
+            }
+
+            return result;
+        }
+
+        template <typename T>
+        size_t Hash(const AstOptional<T>& opt) const
+        {
+            return opt.HasValue() ? Combine(1, Hash(opt.Value())) : 0;
+        }
+
+        // equality
+        //
+
+        bool Equal(const BasicAstToken& lhs, const BasicAstToken& rhs) const
+        {
+            return lhs.Tag() == rhs.Tag() && TextOf(lhs) == TextOf(rhs);
+        }
+
+        template <typename EnumType>
+        bool Equal(const BasicAstEnum<EnumType>& lhs, const BasicAstEnum<EnumType>& rhs) const
+        {
+            return lhs.IntValue() == rhs.IntValue();
+        }
+
+        template <typename T>
+        bool Equal(T* lhs, T* rhs) const
+        {
+            return lhs == rhs;
+        }
+
+        template <typename T>
+        bool Equal(AstVector<T>* lhs, AstVector<T>* rhs) const
+        {
+            if (lhs->Size() != rhs->Size())
+                return false;
+
+            for (int i = 0; i < lhs->Size(); ++i)
+            {
+                if (!Equal(lhs->Value()[i], rhs->Value()[i]))
+                    return false;
+            }
+
+            return true;
+        }
+
+        template <typename T>
+        bool Equal(const AstOptional<T>& lhs, const AstOptional<T>& rhs) const
+        {
+            if (lhs.HasValue() != rhs.HasValue())
+                return false;
+
+            return !lhs.HasValue() || Equal(lhs.Value(), rhs.Value());
+        }
+
+        static size_t Combine(size_t seed, size_t value)
+        {
+            return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+        }
+
+    private:
+        std::string_view TextOf(const BasicAstToken& tok) const
+        {
+            return source_.substr(tok.Offset(), tok.Length());
+        }
+
+        std::string_view source_;
+    };
+}
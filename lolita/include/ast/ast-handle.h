@@ -1,6 +1,7 @@
 #pragma once
 #include "ast/ast-basic.h"
 #include "ast/ast-proxy.h"
+#include "ast/ast-interner.h"
 #include "array-ref.h"
 #include <vector>
 #include <string_view>
@@ -19,6 +20,8 @@ namespace eds::loli::ast
         AstEnumGen(int value)
             : value_(value) {}
 
+        const auto& Value() const { return value_; }
+
         AstItemWrapper Invoke(const AstTypeProxy& proxy, Arena& arena, ArrayRef<AstItemWrapper> rhs) const
         {
             return proxy.ConstructEnum(value_);
@@ -57,6 +60,8 @@ namespace eds::loli::ast
         AstItemSelector(int index)
             : index_(index) {}
 
+        const auto& Index() const { return index_; }
+
         AstItemWrapper Invoke(const AstTypeProxy& proxy, Arena& arena, ArrayRef<AstItemWrapper> rhs) const
         {
             assert(index_ < rhs.Length());
@@ -88,10 +93,16 @@ namespace eds::loli::ast
         AstObjectSetter(const std::vector<SetterPair>& setters)
             : setters_(setters) {}
 
+        const auto& Setters() const { return setters_; }
+
         void Invoke(const AstTypeProxy& proxy, AstItemWrapper obj, ArrayRef<AstItemWrapper> rhs) const
         {
             for (auto setter : setters_)
             {
+                // skip error nodes inserted by recovery
+                if (!rhs.At(setter.symbol_index).HasValue())
+                    continue;
+
                 proxy.AssignField(obj, setter.member_index, rhs.At(setter.symbol_index));
             }
         }
@@ -105,10 +116,16 @@ namespace eds::loli::ast
         AstVectorMerger(const std::vector<int>& indices)
             : indices_(indices) {}
 
+        const auto& Indices() const { return indices_; }
+
         void Invoke(const AstTypeProxy& proxy, AstItemWrapper vec, ArrayRef<AstItemWrapper> rhs) const
         {
             for (auto index : indices_)
             {
+                // skip error nodes inserted by recovery
+                if (!rhs.At(index).HasValue())
+                    continue;
+
                 proxy.PushBackElement(vec, rhs.At(index));
             }
         }
@@ -139,6 +156,10 @@ namespace eds::loli::ast
         AstHandle(const AstTypeProxy* proxy, GenHandle gen, ManipHandle manip)
             : proxy_(proxy), gen_handle_(gen), manip_handle_(manip) {}
 
+        const auto& Proxy() const { return *proxy_; }
+        const auto& Generator() const { return gen_handle_; }
+        const auto& Manipulator() const { return manip_handle_; }
+
         AstItemWrapper Invoke(Arena& arena, ArrayRef<AstItemWrapper> rhs) const
         {
             // construct or select a node
@@ -150,17 +171,65 @@ namespace eds::loli::ast
             std::visit(manip_visitor, manip_handle_);
 
             // update location information
-            auto front_loc = rhs.Front().GetLocationInfo();
-            auto back_loc  = rhs.Back().GetLocationInfo();
+            // NOTE error nodes inserted by recovery hold no value and cover nothing
+            auto location = CombineLocationInfo(rhs.Length(), [&](int index) {
+                return rhs.At(index).HasValue() ? rhs.At(index).GetLocationInfo() : AstLocationInfo{-1, -1};
+            });
 
-            auto offset = front_loc.offset;
-            auto length = back_loc.offset + back_loc.length - offset;
-            result.UpdateLocationInfo(offset, length);
+            if (result.HasValue() && location.offset >= 0)
+            {
+                result.UpdateLocationInfo(location.offset, location.length);
+            }
 
             // return
             return result;
         }
 
+        // same as Invoke, except that a freshly constructed object is hash-consed
+        AstItemWrapper InvokeInterned(AstNodeInterner& interner, Arena& arena, ArrayRef<AstItemWrapper> rhs) const
+        {
+            if (!std::holds_alternative<AstObjectGen>(gen_handle_))
+            {
+                return Invoke(arena, rhs);
+            }
+
+            auto fields = AstNodeInterner::FieldList{};
+            if (auto setter = std::get_if<AstObjectSetter>(&manip_handle_); setter)
+            {
+                for (auto pair : setter->Setters())
+                {
+                    fields.push_back({pair.member_index, rhs.At(pair.symbol_index)});
+                }
+            }
+
+            return interner.Intern(*proxy_, std::move(fields), [&]() { return Invoke(arena, rhs); });
+        }
+
+        // size of an object or vector constructed by this handle, 0 if it constructs nothing in arena
+        size_t ConstructedSize() const
+        {
+            if (std::holds_alternative<AstObjectGen>(gen_handle_))
+            {
+                return proxy_->ObjectSize();
+            }
+            else if (std::holds_alternative<AstVectorGen>(gen_handle_))
+            {
+                return proxy_->VectorSize();
+            }
+            else
+            {
+                return 0;
+            }
+        }
+
+        // if the handle assigns members of a selected object,
+        // which breaks immutability of an object once it's constructed
+        bool MutatesSelection() const
+        {
+            return std::holds_alternative<AstItemSelector>(gen_handle_) &&
+                   std::holds_alternative<AstObjectSetter>(manip_handle_);
+        }
+
     private:
         const AstTypeProxy* proxy_;
 
@@ -0,0 +1,115 @@
+#pragma once
+#include "ast/ast-basic.h"
+#include "ast/ast-comparer.h"
+#include "ast/ast-proxy.h"
+#include "lang-utils.h"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace eds::loli::ast
+{
+    // =====================================================================================
+    // Node Interner
+    //
+
+    // AstNodeInterner hash-conses klass objects during reduction, so that
+    // a structurally identical object is constructed only once and then shared
+    //
+    // NOTE a shared object keeps location information of its first occurrence
+    class AstNodeInterner : NonCopyable, NonMovable
+    {
+    public:
+        struct Statistics
+        {
+            int lookup_count = 0; // klass objects requested
+            int hit_count    = 0; // requests served with an existing object
+
+            double DedupRate() const
+            {
+                return lookup_count != 0 ? static_cast<double>(hit_count) / lookup_count : 0.;
+            }
+        };
+
+        // (member ordinal, value) for each assigned field
+        using FieldList = std::vector<std::pair<int, AstItemWrapper>>;
+
+        AstNodeInterner(std::string_view source)
+            : cmp_(source), table_(0, KeyHasher{}, KeyEqual{&cmp_}) {}
+
+        const auto& Stats() const { return stats_; }
+
+        // lookup an object of the same klass and fields,
+        // or call construct() to make one and register it
+        template <typename F>
+        AstItemWrapper Intern(const AstTypeProxy& proxy, FieldList fields, F construct)
+        {
+            std::sort(fields.begin(), fields.end(),
+                      [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+            auto hash = std::hash<const void*>{}(&proxy);
+            for (const auto& field : fields)
+            {
+                hash = AstItemComparer::Combine(hash, field.first);
+                hash = AstItemComparer::Combine(hash, proxy.HashField(cmp_, field.first, field.second));
+            }
+
+            stats_.lookup_count += 1;
+
+            auto key = Key{&proxy, std::move(fields), hash};
+            if (auto it = table_.find(key); it != table_.end())
+            {
+                stats_.hit_count += 1;
+                return it->second;
+            }
+
+            auto result = construct();
+            table_.emplace(std::move(key), result);
+
+            return result;
+        }
+
+    private:
+        struct Key
+        {
+            const AstTypeProxy* proxy;
+            FieldList fields;
+
+            size_t hash;
+        };
+
+        struct KeyHasher
+        {
+            size_t operator()(const Key& key) const
+            {
+                return key.hash;
+            }
+        };
+        struct KeyEqual
+        {
+            const AstItemComparer* cmp;
+
+            bool operator()(const Key& lhs, const Key& rhs) const
+            {
+                if (lhs.proxy != rhs.proxy || lhs.hash != rhs.hash || lhs.fields.size() != rhs.fields.size())
+                    return false;
+
+                for (int i = 0; i < lhs.fields.size(); ++i)
+                {
+                    const auto& x = lhs.fields[i];
+                    const auto& y = rhs.fields[i];
+
+                    if (x.first != y.first || !lhs.proxy->EqualField(*cmp, x.first, x.second, y.second))
+                        return false;
+                }
+
+                return true;
+            }
+        };
+
+        AstItemComparer cmp_;
+        std::unordered_map<Key, AstItemWrapper, KeyHasher, KeyEqual> table_;
+
+        Statistics stats_ = {};
+    };
+}
@@ -1,8 +1,10 @@
 #pragma once
 #include "core/errors.h"
 #include "ast/ast-basic.h"
+#include "ast/ast-comparer.h"
 #include "memory/arena.h"
 #include <type_traits>
+#include <typeindex>
 #include <unordered_map>
 
 namespace eds::loli::ast
@@ -17,17 +19,32 @@ namespace eds::loli::ast
     {
     public:
         // NOTE a proxy function may only work for a limited set of items
-        // AstEnum: ConstructEnum
-        // AstObject: ConstructObject, AssignField
-        // AstVector: ConstructVector, InsertElement
+        // AstEnum: ConstructEnum, ExtractEnum
+        // AstObject: ConstructObject, AssignField, ExtractField, HashField, EqualField
+        // AstVector: ConstructVector, InsertElement, ReserveElements, ElementCount, ExtractElement
 
         virtual AstItemWrapper ConstructEnum(int value) const = 0;
         virtual AstItemWrapper ConstructObject(Arena&) const  = 0;
         virtual AstItemWrapper ConstructVector(Arena&) const  = 0;
         virtual AstItemWrapper ConstructOptional() const      = 0;
 
+        // bytes taken in arena by ConstructObject and ConstructVector, see ParseStatistics
+        virtual size_t ObjectSize() const = 0;
+        virtual size_t VectorSize() const = 0;
+
         virtual void AssignField(AstItemWrapper obj, int codinal, AstItemWrapper value) const = 0;
         virtual void PushBackElement(AstItemWrapper vec, AstItemWrapper elem) const           = 0;
+        virtual void ReserveElements(AstItemWrapper vec, int capacity) const                  = 0;
+
+        // type-erased inspection of a constructed item
+        virtual int ExtractEnum(AstItemWrapper value) const                        = 0;
+        virtual AstItemWrapper ExtractField(AstItemWrapper obj, int ordinal) const = 0;
+        virtual int ElementCount(AstItemWrapper vec) const                         = 0;
+        virtual AstItemWrapper ExtractElement(AstItemWrapper vec, int index) const = 0;
+
+        // structural hashing of a value to be assigned to a field, see also AstNodeInterner
+        virtual size_t HashField(const AstItemComparer& cmp, int ordinal, AstItemWrapper value) const                  = 0;
+        virtual bool EqualField(const AstItemComparer& cmp, int ordinal, AstItemWrapper lhs, AstItemWrapper rhs) const = 0;
     };
 
     // placeholder proxy
@@ -57,6 +74,15 @@ namespace eds::loli::ast
             Throw();
         }
 
+        size_t ObjectSize() const override
+        {
+            Throw();
+        }
+        size_t VectorSize() const override
+        {
+            Throw();
+        }
+
         void AssignField(AstItemWrapper obj, int codinal, AstItemWrapper value) const override
         {
             Throw();
@@ -65,6 +91,36 @@ namespace eds::loli::ast
         {
             Throw();
         }
+        void ReserveElements(AstItemWrapper vec, int capacity) const override
+        {
+            Throw();
+        }
+
+        int ExtractEnum(AstItemWrapper value) const override
+        {
+            Throw();
+        }
+        AstItemWrapper ExtractField(AstItemWrapper obj, int ordinal) const override
+        {
+            Throw();
+        }
+        int ElementCount(AstItemWrapper vec) const override
+        {
+            Throw();
+        }
+        AstItemWrapper ExtractElement(AstItemWrapper vec, int index) const override
+        {
+            Throw();
+        }
+
+        size_t HashField(const AstItemComparer& cmp, int ordinal, AstItemWrapper value) const override
+        {
+            Throw();
+        }
+        bool EqualField(const AstItemComparer& cmp, int ordinal, AstItemWrapper lhs, AstItemWrapper rhs) const override
+        {
+            Throw();
+        }
 
         static const AstTypeProxy& Instance()
         {
@@ -117,6 +173,22 @@ namespace eds::loli::ast
             return OptionalType{};
         }
 
+        size_t ObjectSize() const override
+        {
+            if constexpr (TraitType::IsKlass())
+            {
+                return sizeof(SelfType);
+            }
+            else
+            {
+                throw ParserInternalError{"BasicAstTypeProxy: T is not a klass type"};
+            }
+        }
+        size_t VectorSize() const override
+        {
+            return sizeof(VectorType);
+        }
+
         void AssignField(AstItemWrapper obj, int ordinal, AstItemWrapper value) const override
         {
             if constexpr (TraitType::IsKlass())
@@ -132,6 +204,78 @@ namespace eds::loli::ast
         {
             vec.Extract<VectorType*>()->PushBack(elem.Extract<StoreType>());
         }
+        void ReserveElements(AstItemWrapper vec, int capacity) const override
+        {
+            vec.Extract<VectorType*>()->Reserve(capacity);
+        }
+
+        int ExtractEnum(AstItemWrapper value) const override
+        {
+            if constexpr (TraitType::IsEnum())
+            {
+                return value.Extract<SelfType>().IntValue();
+            }
+            else
+            {
+                throw ParserInternalError{"BasicAstTypeProxy: T is not an enum type"};
+            }
+        }
+        AstItemWrapper ExtractField(AstItemWrapper obj, int ordinal) const override
+        {
+            if constexpr (TraitType::IsKlass())
+            {
+                return obj.Extract<SelfType*>()->GetItemWrapper(ordinal);
+            }
+            else
+            {
+                throw ParserInternalError{"BasicAstTypeProxy: T is not a klass type"};
+            }
+        }
+        int ElementCount(AstItemWrapper vec) const override
+        {
+            return vec.Extract<VectorType*>()->Size();
+        }
+        AstItemWrapper ExtractElement(AstItemWrapper vec, int index) const override
+        {
+            return vec.Extract<VectorType*>()->Value().at(index);
+        }
+
+        size_t HashField(const AstItemComparer& cmp, int ordinal, AstItemWrapper value) const override
+        {
+            if constexpr (TraitType::IsKlass())
+            {
+                size_t result = 0;
+                SelfType::VisitItemType(ordinal, [&](auto tag) {
+                    using ItemType = std::remove_pointer_t<decltype(tag)>;
+
+                    result = cmp.Hash(value.Extract<ItemType>());
+                });
+
+                return result;
+            }
+            else
+            {
+                throw ParserInternalError{"BasicAstTypeProxy: T is not a klass type"};
+            }
+        }
+        bool EqualField(const AstItemComparer& cmp, int ordinal, AstItemWrapper lhs, AstItemWrapper rhs) const override
+        {
+            if constexpr (TraitType::IsKlass())
+            {
+                bool result = false;
+                SelfType::VisitItemType(ordinal, [&](auto tag) {
+                    using ItemType = std::remove_pointer_t<decltype(tag)>;
+
+                    result = cmp.Equal(lhs.Extract<ItemType>(), rhs.Extract<ItemType>());
+                });
+
+                return result;
+            }
+            else
+            {
+                throw ParserInternalError{"BasicAstTypeProxy: T is not a klass type"};
+            }
+        }
     };
 
     // =====================================================================================
@@ -155,6 +299,20 @@ namespace eds::loli::ast
             }
         }
 
+        // lookup name of the registered type, e.g. dynamic type of an object
+        const std::string& LookupName(std::type_index type) const
+        {
+            auto it = names_.find(type);
+            if (it != names_.end())
+            {
+                return it->second;
+            }
+            else
+            {
+                throw ParserInternalError{"AstTypeProxyManager: specific type not registered"};
+            }
+        }
+
         template <typename EnumType>
         void RegisterEnum(const std::string& name)
         {
@@ -178,10 +336,13 @@ namespace eds::loli::ast
         void RegisterTypeInternal(const std::string& name)
         {
             proxies_[name] = std::make_unique<BasicAstTypeProxy<AstType>>();
+            names_.insert_or_assign(typeid(AstType), name);
         }
 
         using ProxyLookup = std::unordered_map<std::string, std::unique_ptr<AstTypeProxy>>;
+        using NameLookup  = std::unordered_map<std::type_index, std::string>;
 
         ProxyLookup proxies_;
+        NameLookup names_;
     };
 }
\ No newline at end of file
@@ -18,6 +18,17 @@ namespace eds::loli::ast
             throw 0;
         }
 
+        template <typename F>
+        static void VisitItemType(int ordinal, F callback)
+        {
+            throw 0;
+        }
+
+        AstItemWrapper GetItemWrapper(int ordinal) const
+        {
+            throw 0;
+        }
+
         template <int Ordinal>
         const auto& GetItem()
         {
@@ -42,6 +53,45 @@ namespace eds::loli::ast
             }
         }
 
+        // invoke callback with a null pointer to item type at ordinal as a type tag
+        template <typename F>
+        static void VisitItemType(int ordinal, F callback)
+        {
+            if (ordinal == 0)
+            {
+                callback(static_cast<T*>(nullptr));
+            }
+            else
+            {
+                DataBundle<Ts...>::VisitItemType(ordinal - 1, callback);
+            }
+        }
+
+        // type-erased item access, an optional is unwrapped
+        // NOTE empty wrapper is returned for null or absent value
+        AstItemWrapper GetItemWrapper(int ordinal) const
+        {
+            using namespace eds::type;
+
+            if (ordinal != 0)
+            {
+                return rest_.GetItemWrapper(ordinal - 1);
+            }
+
+            if constexpr (Constraint<T>(detail::is_astitem_optional))
+            {
+                return first_.HasValue() ? AstItemWrapper{first_.Value()} : AstItemWrapper{};
+            }
+            else if constexpr (std::is_pointer_v<T>)
+            {
+                return first_ != nullptr ? AstItemWrapper{first_} : AstItemWrapper{};
+            }
+            else
+            {
+                return first_.IsValid() ? AstItemWrapper{first_} : AstItemWrapper{};
+            }
+        }
+
         template <int Ordinal>
         const auto& GetItem() const
         {
@@ -0,0 +1,14 @@
+#pragma once
+#include "ast/ast-basic.h"
+#include "core/parsing-info.h"
+#include "memory/arena.h"
+
+namespace eds::loli
+{
+    // Deep-copy an AST whose root is typed as RootVariable() of info into arena,
+    // where nodes are allocated in preorder and vectors are reserved to their exact size
+    //
+    // NOTE a long-lived AST could be compacted into a fresh arena,
+    //      after which the arena used for parsing could be released
+    ast::AstItemWrapper CompactAst(const ParsingMetaInfo& info, Arena& arena, ast::AstItemWrapper root);
+}
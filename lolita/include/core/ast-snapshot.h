@@ -0,0 +1,100 @@
+#pragma once
+#include "ast/ast-basic.h"
+#include "core/parsing-info.h"
+#include "memory/arena.h"
+#include "array-ref.h"
+#include <cstdint>
+#include <vector>
+
+// Binary snapshot of a syntax tree
+//
+// A snapshot is a flat array of 32-bit words:
+// - header: magic, version, word count, layout fingerprint in 2 words, followed by the root item
+// - klass record: klass index, offset, length, followed by fields in member order
+// - vector record: element count, offset, length, followed by elements
+//
+// and item encodings:
+// - token: tag, offset, length
+// - enum: value, offset, length
+// - object or vector: reference to its record
+// - optional: presence flag, followed by the element
+//
+// NOTE a reference is relative to the position of itself and 0 stands for null,
+//      so that a snapshot is position-independent and could be used in place, e.g. mmapped
+// NOTE a reference always points forward, and the fingerprint covers token tags and layouts of enums
+//      and klasses, so that a snapshot of another grammar or a corrupt one is rejected rather than misread
+namespace eds::loli
+{
+    class AstSnapshotView;
+
+    // =====================================================================================
+    // Save & Load
+    //
+
+    // serialize an AST whose root is typed as RootVariable() of info
+    // NOTE objects shared in the AST are written only once
+    std::vector<int32_t> SaveAstSnapshot(const ParsingMetaInfo& info, ast::AstItemWrapper root);
+
+    // rebuild an AST into arena using proxies in info's environment
+    // NOTE it throws ParserInternalError if data is not a valid snapshot of the grammar
+    ast::AstItemWrapper LoadAstSnapshot(const ParsingMetaInfo& info, Arena& arena, ArrayRef<const int32_t> data);
+
+    // =====================================================================================
+    // In-place View
+    //
+
+    // A read-only handle to a record in a snapshot, which could be either
+    // a klass record or a vector record
+    class AstSnapshotNode
+    {
+    public:
+        AstSnapshotNode(const AstSnapshotView* view, int pos, TypeSpec type)
+            : view_(view), pos_(pos), type_(type) {}
+
+        bool IsNull() const { return pos_ == 0; }
+        bool IsVector() const { return type_.IsVector(); }
+
+        // klass of the record, not available for vectors
+        const KlassTypeInfo& Klass() const;
+
+        ast::AstLocationInfo GetLocationInfo() const;
+
+        // klass fields by member ordinal
+        ast::BasicAstToken Token(int ordinal) const;
+        int Enum(int ordinal) const;
+        AstSnapshotNode Object(int ordinal) const;
+        AstSnapshotNode Vector(int ordinal) const;
+
+        // vector elements
+        int Size() const;
+        ast::BasicAstToken TokenElement(int index) const;
+        int EnumElement(int index) const;
+        AstSnapshotNode Element(int index) const;
+
+    private:
+        int MemberPosition(int ordinal, TypeSpec& type) const;
+        int ElementPosition(int index, TypeSpec& type) const;
+        AstSnapshotNode Follow(int ref_pos, TypeSpec type) const;
+
+        const AstSnapshotView* view_;
+        int pos_;
+        TypeSpec type_;
+    };
+
+    class AstSnapshotView
+    {
+    public:
+        // NOTE data is not copied, and it throws ParserInternalError if data is not a snapshot of the grammar
+        AstSnapshotView(const ParsingMetaInfo& info, ArrayRef<const int32_t> data);
+
+        const auto& Info() const { return info_; }
+        const auto& Data() const { return data_; }
+
+        // only available if root is either an object or a vector
+        AstSnapshotNode Root() const;
+
+    private:
+        const ParsingMetaInfo& info_;
+        ArrayRef<const int32_t> data_;
+    };
+}
@@ -0,0 +1,240 @@
+#pragma once
+#include "core/parsing-info.h"
+#include "container/heap-array.h"
+#include "lang-utils.h"
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <variant>
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // Parsing Actions
+    //
+
+    struct ActionError
+    {
+    };
+
+    struct ActionShift
+    {
+        int target_state;
+    };
+    struct ActionReduce
+    {
+        const ProductionInfo* production;
+    };
+    using ParsingAction = std::variant<ActionError, ActionShift, ActionReduce>;
+
+    // =====================================================================================
+    // Table Footprint
+    //
+
+    enum class TableEncoding
+    {
+        // a column for each character of lexing states, and for each term or variable of parsing states
+        Dense,
+
+        // characters with identical transitions in all lexing states share a column,
+        // and rows of parsing states are displaced to overlap where they have no action or goto,
+        // which costs an extra check of the owner of a cell on lookup
+        Compact,
+    };
+
+    // bytes taken by a CompiledGrammar, see CompiledGrammar::Footprint
+    struct TableFootprint
+    {
+        TableEncoding encoding = TableEncoding::Dense;
+
+        size_t lexing_table_bytes     = 0;
+        size_t acc_token_lookup_bytes = 0;
+
+        // NOTE action and goto tables include their check tables of the compact encoding
+        size_t action_table_bytes     = 0;
+        size_t eof_action_table_bytes = 0;
+        size_t goto_table_bytes       = 0;
+
+        // character classes and row offsets of the encoding, and lookups of sync and split tokens and start symbols
+        size_t auxiliary_bytes = 0;
+
+        // retained ParsingMetaInfo, see ParsingMetaInfo::MemoryFootprint
+        size_t meta_info_bytes = 0;
+
+        size_t TableBytes() const
+        {
+            return lexing_table_bytes + acc_token_lookup_bytes +
+                   action_table_bytes + eof_action_table_bytes + goto_table_bytes + auxiliary_bytes;
+        }
+        size_t TotalBytes() const
+        {
+            return TableBytes() + meta_info_bytes;
+        }
+    };
+
+    // =====================================================================================
+    // CompiledGrammar
+    //
+
+    // Tables of lexing and parsing automata of a grammar along with meta information needed at runtime,
+    // i.e. productions to reduce with their handles, symbols, types and start symbols, see CompileGrammar
+    // NOTE it's immutable once compiled, where data of meta information only used to build automata is released,
+    //      see ParsingMetaInfo::ReleaseConstructionData
+    class CompiledGrammar : NonCopyable, NonMovable
+    {
+    public:
+        const auto& Info() const { return *info_; }
+
+        int TokenCount() const { return token_num_; }
+        int TermCount() const { return term_num_; }
+        int VariableCount() const { return nonterm_num_; }
+
+        int LexingStateCount() const { return dfa_state_num_; }
+        int ParsingStateCount() const { return pda_state_num_; }
+
+        TableEncoding Encoding() const { return encoding_; }
+
+        // bytes taken by each of tables and the retained meta information
+        TableFootprint Footprint() const;
+
+        bool VerifyCharacter(int ch) const
+        {
+            return ch >= 0 && ch < 128;
+        }
+        bool VerifyLexingState(int state) const
+        {
+            return state >= 0 && state < dfa_state_num_;
+        }
+        bool VerifyParsingState(int state) const
+        {
+            return state >= 0 && state < pda_state_num_;
+        }
+
+        bool IsSyncToken(int term_id) const
+        {
+            assert(term_id >= 0 && term_id < term_num_);
+            return sync_token_lookup_[term_id];
+        }
+        bool IsSplitToken(int term_id) const
+        {
+            assert(term_id >= 0 && term_id < term_num_);
+            return split_token_lookup_[term_id];
+        }
+        bool IsAcceptingVariable(int nonterm_id) const
+        {
+            assert(nonterm_id >= 0 && nonterm_id < nonterm_num_);
+            return accepting_variable_lookup_[nonterm_id];
+        }
+
+        // ids of variables an error node may stand for in order of preference, see OrderRecoveryVariables
+        const auto& RecoveryVariables() const
+        {
+            return recovery_variables_;
+        }
+
+        // state expecting the start symbol of entry_index of ParsingMetaInfo::Entries()
+        int LookupEntryState(int entry_index) const
+        {
+            return entry_state_table_[entry_index];
+        }
+
+        int LookupLexingTransition(int state, int ch) const
+        {
+            assert(VerifyLexingState(state) && VerifyCharacter(ch));
+            return lexing_table_[lexing_class_num_ * state + lexing_class_lookup_[ch]];
+        }
+        const TokenInfo* LookupAcceptedToken(int state) const
+        {
+            assert(VerifyLexingState(state));
+            return acc_token_lookup_[state];
+        }
+        ParsingAction LookupParsingAction(int state, int term_id) const
+        {
+            assert(VerifyParsingState(state) && term_id >= 0 && term_id < term_num_);
+            const auto index = action_row_lookup_[state] + term_id;
+            if (encoding_ == TableEncoding::Compact && action_check_[index] != state)
+                return ActionError{};
+
+            return action_table_[index];
+        }
+        ParsingAction LookupParsingActionOnEof(int state) const
+        {
+            assert(VerifyParsingState(state));
+            return eof_action_table_[state];
+        }
+        int LookupParsingGoto(int state, int nonterm_id) const
+        {
+            assert(VerifyParsingState(state) && nonterm_id >= 0 && nonterm_id <= nonterm_num_);
+            const auto index = goto_row_lookup_[state] + nonterm_id;
+            if (encoding_ == TableEncoding::Compact && goto_check_[index] != state)
+                return -1;
+
+            return goto_table_[index];
+        }
+
+    private:
+        friend std::unique_ptr<const CompiledGrammar> CompileGrammar(const std::string& config, const ast::AstTypeProxyManager* env, size_t table_budget);
+
+        void Initialize(const std::string& config, const ast::AstTypeProxyManager* env, size_t table_budget);
+
+        // switch dense tables to TableEncoding::Compact
+        void CompactTables();
+
+    private:
+        // meta information
+        std::unique_ptr<ParsingMetaInfo> info_;
+
+        // parser
+        int token_num_;
+        int term_num_;
+        int nonterm_num_;
+
+        int dfa_state_num_;
+        int pda_state_num_;
+
+        TableEncoding encoding_;
+
+        // NOTE a character is looked up in the column of its class, which is itself if tables are dense
+        int lexing_class_num_;
+
+        container::HeapArray<const TokenInfo*> acc_token_lookup_; // 1 column, token_num_ rows
+        container::HeapArray<uint8_t> lexing_class_lookup_;       // 1 column, 128 rows
+        container::HeapArray<int> lexing_table_;                  // lexing_class_num_ columns, dfa_state_num_ rows
+
+        // NOTE a parsing state is looked up in the row at its offset, where rows of compact tables overlap
+        //      and a cell is only valid for the state in the check table
+        container::HeapArray<int> action_row_lookup_;          // 1 column, pda_state_num_ rows
+        container::HeapArray<int> goto_row_lookup_;            // 1 column, pda_state_num_ rows
+        container::HeapArray<ParsingAction> action_table_;     // term_num_ columns, pda_state_num_ rows if dense
+        container::HeapArray<ParsingAction> eof_action_table_; // 1 column, pda_state_num_ rows
+        container::HeapArray<int> goto_table_;                 // nonterm_num_ columns, pda_state_num_ rows if dense
+        container::HeapArray<int> action_check_;               // same as action_table_, empty if dense
+        container::HeapArray<int> goto_check_;                 // same as goto_table_, empty if dense
+
+        container::HeapArray<bool> sync_token_lookup_;  // 1 column, term_num_ rows
+        container::HeapArray<bool> split_token_lookup_; // 1 column, term_num_ rows
+        container::HeapArray<int> recovery_variables_;  // 1 column, a row for each variable an error node may stand for
+
+        // multiple start symbols
+        container::HeapArray<bool> accepting_variable_lookup_; // 1 column, nonterm_num_ rows
+        container::HeapArray<int> entry_state_table_;          // 1 column, a row for each of ParsingMetaInfo::Entries()
+    };
+
+    // resolve config and build tables of its automata, where table_budget limits TableFootprint::TableBytes(),
+    // or 0 for no limit, and tables are dense if they fit in the budget, otherwise compact
+    // NOTE it throws ParserConstructionError if even compact tables exceed the budget
+    std::unique_ptr<const CompiledGrammar> CompileGrammar(const std::string& config, const ast::AstTypeProxyManager* env, size_t table_budget = 0);
+
+    // same as CompileGrammar, except that a grammar is compiled once for the same config, env and table_budget,
+    // which is shared by all callers as long as any of them still refers to it
+    // NOTE it's thread-safe, where callers of the same arguments wait for a single compilation,
+    //      and grammars of different arguments are compiled concurrently
+    // NOTE grammars are told apart by the address of env, so env must outlive every grammar compiled with it,
+    //      which refers to it anyway, otherwise another env at the same address may pick up a stale grammar
+    std::shared_ptr<const CompiledGrammar> LoadSharedGrammar(const std::string& config, const ast::AstTypeProxyManager* env, size_t table_budget = 0);
+
+    // drop registry entries of shared grammars no longer referred to, returns the number dropped
+    // NOTE the registry never keeps a grammar alive, and LoadSharedGrammar drops such entries as well
+    int ReleaseUnusedGrammars();
+}
@@ -69,6 +69,7 @@ namespace eds::loli::config
     {
         std::vector<RuleSymbol> rhs;
         std::optional<QualType> klass_hint; // for enum hint, qualifier should be empty
+        std::string action;                 // "" or id
     };
 
     struct RuleDefinition
@@ -90,6 +91,10 @@ namespace eds::loli::config
         std::vector<BaseDefinition> bases;
         std::vector<NodeDefinition> nodes;
         std::vector<RuleDefinition> rules;
+
+        std::vector<std::string> sync_tokens;  // id
+        std::vector<std::string> split_tokens; // id
+        std::vector<std::string> entries;      // id
     };
 
     std::unique_ptr<ParsingConfiguration> ParseConfig(const std::string& data);
@@ -0,0 +1,143 @@
+#pragma once
+#include "ast/ast-basic.h"
+#include "core/parsing-info.h"
+#include "core/token-buffer.h"
+#include "core/text-anchors.h"
+#include "memory/arena.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace eds::loli
+{
+    class GenericParser;
+    class IncrementalContext;
+    class ReusableNodeCursor;
+
+    // =====================================================================================
+    // IncrementalDocument
+    //
+
+    // A parsed text retaining its tokens and syntax tree, where each node records the parser state
+    // it was shifted in and the number of tokens it covers, so that subtrees unaffected by an edit
+    // could be reused when reparsing
+    //
+    // Nodes only know sizes of their children rather than their positions, so a subtree reused
+    // by the next revision is shared as is instead of being copied or moved. For the same reason,
+    // locations stored in the syntax tree are anchors of TextAnchors rather than offsets into the
+    // current text, see LocationOf. Items of an earlier revision are never modified by a later one,
+    // and their locations are mapped the same way as long as their text is not removed.
+    //
+    // Items are allocated in an arena owned by the document, which is rebuilt with only the current tree
+    // once items dropped by earlier revisions far outnumber it, so memory stays proportional to the tree.
+    //
+    // NOTE items of earlier revisions, e.g. a previous Root(), are released when the arena is rebuilt,
+    //      see Statistics::arena_rebuilt
+    class IncrementalDocument
+    {
+    public:
+        struct Statistics
+        {
+            // nodes taken from the previous tree
+            int reused_node_count = 0;
+
+            // tokens actually fed to the parser
+            int shifted_token_count = 0;
+
+            // tokens produced by the lexer
+            int relexed_token_count = 0;
+
+            // if the arena is rebuilt, which releases items of earlier revisions
+            bool arena_rebuilt = false;
+        };
+
+        IncrementalDocument(std::string text)
+            : arena_(std::make_unique<Arena>()), tokens_(std::move(text)), anchors_(tokens_.Text().length()) {}
+
+        const auto& Text() const { return tokens_.Text(); }
+        const auto& Tokens() const { return tokens_; }
+
+        // empty if the last parse is rejected
+        const auto& Root() const { return root_; }
+
+        // statistics of the last parse
+        const auto& Stats() const { return stats_; }
+
+        // location in the current text of a location stored in the syntax tree,
+        // where offset is -1 if the item covers nothing or its text is removed
+        ast::AstLocationInfo LocationOf(ast::AstLocationInfo stored) const
+        {
+            if (stored.offset < 0)
+                return stored;
+
+            const auto offset = anchors_.ToOffset(stored.offset);
+            return offset < 0 ? ast::AstLocationInfo{-1, -1} : ast::AstLocationInfo{offset, stored.length};
+        }
+
+    private:
+        friend class GenericParser;
+        friend class IncrementalContext;
+        friend class ReusableNodeCursor;
+
+        struct Node
+        {
+            // nullptr if it's a token
+            const ProductionInfo* production;
+
+            // state on top of the stack right before the node
+            int state;
+
+            // tokens covered by its subtree
+            int token_count;
+
+            // nodes in its subtree, including itself
+            int node_count;
+
+            // children are child_pool_[first_child, first_child + production->Right().size())
+            int first_child;
+
+            // if its value is modified by the parent, i.e. selected, which forbids reusing it alone
+            // unless it's a list, which is copied instead, see element_count
+            bool selected;
+
+            // elements of a list value when it's reduced, as the same list is merged into by its parents
+            int element_count;
+
+            ast::AstItemWrapper value;
+        };
+
+        void ResetTree()
+        {
+            nodes_.clear();
+            child_pool_.clear();
+
+            root_node_ = -1;
+            root_      = {};
+        }
+
+        // drop nodes unreachable from the root, keeping their order
+        void CompactNodes();
+
+        // reconstruct items of the current tree in a new arena by reducing nodes again, and release the old one
+        // NOTE nodes must be compacted beforehand
+        void RebuildArena();
+
+        std::unique_ptr<Arena> arena_;
+
+        // nodes created since the arena is rebuilt, which approximates items allocated in it
+        int arena_node_count_ = 0;
+        TokenBuffer tokens_;
+        TextAnchors anchors_;
+
+        // nodes of the current tree and, until being compacted, those dropped by previous revisions,
+        // where a node always follows its children
+        std::vector<Node> nodes_     = {};
+        std::vector<int> child_pool_ = {};
+
+        // -1 if none
+        int root_node_ = -1;
+
+        ast::AstItemWrapper root_ = {};
+        Statistics stats_         = {};
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "core/parsing-info.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // ParseStatistics
+    //
+
+    // Counters of a parse, see GenericParser::TryParseWithStatistics
+    // NOTE statistics are only collected if lolita is built with LOLITA_PARSE_STATISTICS,
+    //      otherwise the parsing loop is left untouched
+    struct ParseStatistics
+    {
+        struct ProductionCounter
+        {
+            int64_t reduction_count = 0;
+
+            // time taken by AST construction of reductions
+            int64_t reduction_nanoseconds = 0;
+        };
+
+        // tokens shifted, excluding variables shifted after a reduction
+        int64_t shift_count = 0;
+
+        // indexed by ProductionInfo::Id()
+        std::vector<ProductionCounter> productions = {};
+
+        int max_stack_depth = 0;
+
+        // characters stepped by the lexer, of which those examined beyond the longest match
+        // are stepped again as part of the next token
+        int64_t lexed_bytes     = 0;
+        int64_t rescanned_bytes = 0;
+
+        int64_t ignored_token_count = 0;
+
+        // sizes of objects and vectors constructed by reductions
+        // NOTE it's not what the arena takes, which rounds and preallocates blocks,
+        //      and storage of vector elements is allocated on heap instead
+        int64_t constructed_node_bytes = 0;
+
+        int64_t ReductionCount() const;
+        int64_t ReductionNanoseconds() const;
+
+        // accumulate counters of another parse of the same grammar
+        void Merge(const ParseStatistics& other);
+    };
+
+    enum class HotProductionOrder
+    {
+        ReductionCount,
+        ReductionTime,
+    };
+
+    // productions that are reduced at least once, hottest first
+    std::vector<const ProductionInfo*> RankHotProductions(const ParsingMetaInfo& info, const ParseStatistics& stats, HotProductionOrder order);
+
+    // write a summary of stats and a table of the hottest productions at most max_rows
+    void WriteHotProductionReport(std::ostream& output, const ParsingMetaInfo& info, const ParseStatistics& stats,
+                                  HotProductionOrder order = HotProductionOrder::ReductionTime, int max_rows = 20);
+}
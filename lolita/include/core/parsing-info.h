@@ -33,6 +33,16 @@ namespace eds::loli
     public:
         class Builder;
 
+        // a start symbol X declared besides the root, which is parsed via an augmented production `#entry-X -> #marker-X X`,
+        // where the marker variable has no production and only takes the parser from the initial state
+        // into the state expecting X, so that all start symbols share a single automaton
+        struct EntryInfo
+        {
+            const VariableInfo* variable;
+            const VariableInfo* marker;
+            const VariableInfo* augmented;
+        };
+
         const auto& Environment() const { return env_; }
 
         // assumes last variable is root
@@ -47,6 +57,27 @@ namespace eds::loli
         const auto& Variables() const { return variables_; }
         const auto& Productions() const { return productions_; }
 
+        // tokens where error recovery resumes
+        const auto& SyncTokens() const { return sync_tokens_; }
+
+        // tokens where input may be split for parallel parsing
+        const auto& SplitTokens() const { return split_tokens_; }
+
+        // additional start symbols, see EntryInfo
+        const auto& Entries() const { return entries_; }
+
+        // nullptr if there's no entry named so
+        const EntryInfo* LookupEntry(const std::string& name) const;
+
+        // bytes taken by the info, including regex trees, handles, strings and lookup maps
+        size_t MemoryFootprint() const;
+
+        // release data only used to build automata, i.e. regex trees and text definitions of tokens
+        // and the lookup of symbols by name, where the info of a CompiledGrammar is released so
+        // NOTE TokenInfo::TreeDefinition() is nullptr and LookupSymbol throws afterwards,
+        //      resolve the config again if they are needed, e.g. for SentenceGenerator
+        void ReleaseConstructionData();
+
         const auto& LookupType(const std::string& name) const
         {
             return type_lookup_.at(name);
@@ -77,6 +108,11 @@ namespace eds::loli
         container::HeapArray<TokenInfo> ignored_tokens_;
         container::HeapArray<VariableInfo> variables_;
         container::HeapArray<ProductionInfo> productions_;
+
+        std::vector<const TokenInfo*> sync_tokens_;
+        std::vector<const TokenInfo*> split_tokens_;
+
+        std::vector<EntryInfo> entries_;
     };
 
     // pass nullptr if there's no proxy manager
@@ -277,6 +313,7 @@ namespace eds::loli
         const auto& TreeDefinition() const { return ast_def_; }
 
     private:
+        friend class ParsingMetaInfo;
         friend class ParsingMetaInfo::Builder;
 
         std::string text_def_;
@@ -310,17 +347,26 @@ namespace eds::loli
     class ProductionInfo
     {
     public:
+        // index into ParsingMetaInfo::Productions()
+        const auto& Id() const { return id_; }
+
         const auto& Left() const { return lhs_; }
         const auto& Right() const { return rhs_; }
 
         const auto& Handle() const { return handle_; }
 
+        // name of the bound semantic action, empty if none
+        const auto& Action() const { return action_; }
+
     private:
         friend class ParsingMetaInfo::Builder;
 
+        int id_;
+
         VariableInfo* lhs_;
         std::vector<SymbolInfo*> rhs_;
 
         std::unique_ptr<ast::AstHandle> handle_;
+        std::string action_;
     };
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+#include "ast/ast-basic.h"
+#include "core/parsing-info.h"
+#include "memory/arena.h"
+#include "array-ref.h"
+#include <vector>
+#include <unordered_map>
+
+namespace eds::loli
+{
+    class ReductionLog;
+
+    // =====================================================================================
+    // LazyAstNode
+    //
+
+    // A handle to a node recorded in a ReductionLog
+    // the syntax tree could be navigated without any construction
+    // and a subtree is built only when it's materialized
+    class LazyAstNode
+    {
+    public:
+        LazyAstNode(ReductionLog* log, int index)
+            : log_(log), index_(index) {}
+
+        const auto& Index() const { return index_; }
+
+        bool IsToken() const;
+
+        // nullptr if it's a token
+        const ProductionInfo* Production() const;
+        const VariableInfo* Variable() const;
+
+        ast::AstLocationInfo GetLocationInfo() const;
+
+        // children are corresponding to right-hand side of the production
+        std::vector<LazyAstNode> Children() const;
+        LazyAstNode Child(int index) const;
+
+        // build the subtree rooted at this node
+        // NOTE result is cached unless it's selected by the parent, which may modify it,
+        //      so that a node is materialized at most once for the same arena
+        ast::AstItemWrapper Materialize(Arena& arena) const;
+
+        template <typename T>
+        T MaterializeAs(Arena& arena) const
+        {
+            return Materialize(arena).Extract<T>();
+        }
+
+    private:
+        ReductionLog* log_;
+        int index_;
+    };
+
+    // =====================================================================================
+    // ReductionLog
+    //
+
+    // A compact record of shift/reduce sequence of a successful parse in post-order,
+    // i.e. a subtree always occupies a continuous range ending at its root
+    class ReductionLog
+    {
+    public:
+        struct Entry
+        {
+            // nullptr if it's a shift
+            const ProductionInfo* production;
+
+            // token tag for shift, index of the first entry of subtree for reduce
+            int value;
+
+            int offset;
+            int length;
+
+            // if the parent production selects its value, e.g. a list merged in place
+            bool selected = false;
+        };
+
+        int Size() const { return entries_.size(); }
+        const Entry& At(int index) const { return entries_.at(index); }
+
+        bool IsShift(int index) const { return At(index).production == nullptr; }
+        int SubtreeBegin(int index) const
+        {
+            return IsShift(index) ? index : At(index).value;
+        }
+
+        // root of the syntax tree is always the last entry
+        LazyAstNode Root()
+        {
+            assert(!entries_.empty());
+            return LazyAstNode{this, Size() - 1};
+        }
+
+        // returns index of the new entry
+        int RecordShift(const ast::BasicAstToken& tok);
+        int RecordReduce(const ProductionInfo& production, ArrayRef<int> children);
+
+        ast::AstItemWrapper Materialize(Arena& arena, int index);
+
+    private:
+        std::vector<Entry> entries_ = {};
+
+        // materialized subtrees and the arena they live in
+        Arena* materialized_arena_                                 = nullptr;
+        std::unordered_map<int, ast::AstItemWrapper> materialized_ = {};
+    };
+}
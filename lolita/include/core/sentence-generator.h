@@ -0,0 +1,136 @@
+#pragma once
+#include "core/parsing-info.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // SentenceGenerator
+    //
+
+    // Random sentences of a grammar, e.g. inputs of benchmarks and fuzzing
+    //
+    // Each symbol to expand is given a budget, i.e. the offset of output where its sentence should end.
+    // A directly recursive variable is generated as a list that keeps growing until its budget is used up,
+    // where each element takes a random share of the budget, while other variables split their budget
+    // among children. A variable nested too deep or out of budget takes the derivation that terminates soonest.
+    //
+    // Tokens are rendered from samples of their regex which the lexer reads back as the same token,
+    // and separated by samples of ignored tokens.
+    // NOTE a sentence might still be rejected if an ignored token could extend the token preceding it
+    // NOTE info should keep regex trees of tokens, which is not the case for GrammarInfo() of a parser,
+    //      see ParsingMetaInfo::ReleaseConstructionData
+    class SentenceGenerator
+    {
+    public:
+        struct Options
+        {
+            // nesting depth beyond which derivations are cut short, where a list doesn't nest into its elements
+            int max_depth = 12;
+
+            // maximum share of budget taken by an element of a list
+            int element_size = 256;
+
+            uint64_t seed = 0;
+        };
+
+        SentenceGenerator(const ParsingMetaInfo& info, Options options);
+        SentenceGenerator(const ParsingMetaInfo& info)
+            : SentenceGenerator(info, Options{}) {}
+
+        const auto& GrammarInfo() const { return info_; }
+
+        // append a sentence of variable to output, which ends around size bytes after where it starts
+        // NOTE it throws ParserInternalError if variable derives no sentence made of renderable tokens
+        void Generate(std::string& output, const VariableInfo& variable, size_t size);
+
+        // same as above for root variable
+        void Generate(std::string& output, size_t size)
+        {
+            Generate(output, info_.RootVariable(), size);
+        }
+
+    private:
+        static constexpr size_t kInfiniteCost = SIZE_MAX / 4;
+        static constexpr int kInfiniteHeight  = INT32_MAX;
+
+        struct Pending
+        {
+            const SymbolInfo* symbol;
+
+            // offset of output where the sentence of symbol should end
+            size_t end;
+
+            int depth;
+
+            // for a list in progress, which adds an element each time it's popped, see ExpandTail
+            bool list_tail;
+            bool left_recursive;
+
+            // output size when the list added its last element, -1 for none yet
+            int64_t mark;
+        };
+
+        // productions of a variable by where it recurs directly
+        struct Shape
+        {
+            std::vector<const ProductionInfo*> left_recursive;
+            std::vector<const ProductionInfo*> right_recursive;
+            std::vector<const ProductionInfo*> others;
+        };
+
+        void LoadSamples();
+        void ComputeCosts();
+
+        void Emit(std::string& output, const TokenInfo& token);
+        void Expand(std::string& output, const Pending& pending);
+        void ExpandTail(std::string& output, const Pending& pending);
+
+        // push symbols[first, last) in reverse order, splitting budget after offset begin among them
+        void PushSequence(const std::vector<SymbolInfo*>& symbols, int first, int last, size_t begin, size_t budget, int depth);
+
+        // the derivation that terminates soonest, i.e. whose children have lower heights
+        const ProductionInfo* ShortestProduction(const VariableInfo& variable) const;
+
+        // a random production whose minimum sentence fits in budget, nullptr if none
+        const ProductionInfo* RandomProduction(const std::vector<const ProductionInfo*>& candidates, size_t budget);
+
+        // a random share of budget for an element of a list
+        size_t ElementShare(size_t min_cost, size_t budget)
+        {
+            auto max_cost = std::max(min_cost, std::min(budget, static_cast<size_t>(options_.element_size)));
+            return RandomBetween(min_cost, max_cost);
+        }
+
+        size_t RandomBetween(size_t min, size_t max)
+        {
+            return std::uniform_int_distribution<size_t>{min, max}(random_);
+        }
+
+        size_t CostOf(const SymbolInfo* symbol) const;
+        size_t CostOf(const std::vector<SymbolInfo*>& symbols, int first, int last) const;
+        int HeightOf(const ProductionInfo* production) const;
+
+        const ParsingMetaInfo& info_;
+        Options options_;
+
+        std::mt19937_64 random_;
+
+        // validated renderings of each token, indexed by id
+        std::vector<std::vector<std::string>> token_samples_;
+        std::vector<std::string> separator_samples_;
+
+        // minimum output length of a symbol and minimum derivation height of a variable, indexed by id
+        std::vector<size_t> token_costs_;
+        std::vector<size_t> variable_costs_;
+        std::vector<int> variable_heights_;
+
+        std::vector<Shape> shapes_;
+
+        std::vector<Pending> stack_;
+    };
+}
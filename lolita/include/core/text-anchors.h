@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <cassert>
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // TextAnchors
+    //
+
+    // Positions of characters that stay put while a text is edited
+    //
+    // Characters of the original text are anchored at their offsets, and characters inserted by an edit
+    // take fresh anchors following all existing ones, so that a character keeps its anchor as long as
+    // it stays in the text. The text is kept as pieces of consecutive anchors, which grow with
+    // the number of edits rather than the length of the text.
+    class TextAnchors
+    {
+    public:
+        TextAnchors(int length = 0)
+        {
+            Reset(length);
+        }
+
+        // anchor a new text of length characters at their offsets
+        void Reset(int length);
+
+        // replace removed_length characters at offset with inserted_length new ones
+        void Replace(int offset, int removed_length, int inserted_length);
+
+        // anchor of the character at offset
+        int ToAnchor(int offset) const;
+
+        // offset of the character at anchor, -1 if it's removed
+        int ToOffset(int anchor) const;
+
+    private:
+        struct Piece
+        {
+            int offset;
+            int anchor;
+            int length;
+        };
+
+        // pieces in order of offset, and the same pieces in order of anchor
+        std::vector<Piece> pieces_       = {};
+        std::vector<Piece> anchor_order_ = {};
+
+        int next_anchor_ = 0;
+    };
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "ast/ast-basic.h"
+#include <string>
+#include <vector>
+#include <cassert>
+
+namespace eds::loli
+{
+    class GenericParser;
+
+    // =====================================================================================
+    // TokenBuffer
+    //
+
+    // A text with its tokens kept across edits, where ignored tokens are dropped
+    //
+    // Each token also records how far the lexer has looked ahead to produce it and ignored tokens
+    // following it, so that an edit only relexes tokens whose lookahead reaches the edited text
+    // until the new tokens resynchronize with old ones. Offsets of the tail after the edit
+    // are shifted lazily, i.e. only those next to a later edit are actually updated.
+    class TokenBuffer
+    {
+    public:
+        // tokens replaced by the last edit
+        struct Damage
+        {
+            // index of the first token replaced
+            int first_token = 0;
+
+            // number of old tokens replaced and their replacement
+            int removed_count  = 0;
+            int inserted_count = 0;
+
+            // offset difference of tokens following the replacement
+            int offset_delta = 0;
+
+            // characters scanned to relex the replacement
+            int relexed_length = 0;
+        };
+
+        TokenBuffer(std::string text)
+            : text_(std::move(text)) {}
+
+        const auto& Text() const { return text_; }
+
+        // false if the text failed to be tokenized, which would be retokenized as a whole next time
+        bool IsValid() const { return valid_; }
+
+        const auto& LastDamage() const { return damage_; }
+
+        int Size() const { return entries_.size(); }
+
+        ast::BasicAstToken At(int index) const
+        {
+            assert(index >= 0 && index < Size());
+
+            const auto& entry = entries_[index];
+            return ast::BasicAstToken{entry.offset + ShiftOf(index), entry.length, entry.tag};
+        }
+
+    private:
+        friend class GenericParser;
+
+        struct Entry
+        {
+            int offset;
+            int length;
+            int tag;
+
+            // maximum position the lexer has examined to produce tokens up to this one,
+            // including ignored tokens following it, exclusive
+            // NOTE reaching the end of text counts as examining one more character
+            int scan_end;
+        };
+
+        int ShiftOf(int index) const
+        {
+            return index >= shift_begin_ ? shift_delta_ : 0;
+        }
+        int ScanEndOf(int index) const
+        {
+            return entries_[index].scan_end + ShiftOf(index);
+        }
+
+        // drop all tokens and reset text
+        void Reset(bool valid);
+
+        // first token whose lookahead reaches offset, or Size() if none
+        int FindAffected(int offset) const;
+
+        // replace tokens in [first, last) with replacement whose offsets are up to date,
+        // and move tokens after them by delta characters, where scan_end is the lookahead of relexing
+        void Splice(int first, int last, const std::vector<Entry>& replacement, int delta, int scan_end);
+
+        // move the boundary of the pending shift to index, updating tokens in between
+        void MoveShiftBoundary(int index);
+
+        std::string text_;
+        bool valid_ = false;
+
+        std::vector<Entry> entries_ = {};
+
+        // tokens starting from shift_begin_ are yet to be moved by shift_delta_ characters
+        int shift_begin_ = 0;
+        int shift_delta_ = 0;
+
+        Damage damage_ = {};
+    };
+}
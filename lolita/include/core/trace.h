@@ -0,0 +1,105 @@
+#pragma once
+#include "lang-utils.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace eds::loli
+{
+    // =====================================================================================
+    // Tracing
+    //
+
+    // a completed span, see TraceSpan
+    struct TraceEvent
+    {
+        const char* name;
+        const char* category;
+
+        // in microseconds since the tracer is created
+        double start_us;
+        double duration_us;
+
+        // threads are numbered from 1 in order of their first event
+        int thread_id;
+
+        // counts of the phase, e.g. states and items
+        std::vector<std::pair<const char*, int64_t>> counters;
+    };
+
+    // Spans of construction and parsing phases collected from all threads while installed, see InstallTracer
+    // NOTE spans only cover coarse phases, so that they are simply recorded under a lock
+    class Tracer : NonCopyable, NonMovable
+    {
+    public:
+        Tracer()
+            : origin_(std::chrono::steady_clock::now()) {}
+
+        // microseconds since the tracer is created
+        double Now() const
+        {
+            return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin_).count();
+        }
+
+        void Record(TraceEvent event);
+
+        // a copy of events recorded so far, ordered by end time
+        std::vector<TraceEvent> Events() const;
+
+        // write events in Chrome trace event format, which is loaded by chrome://tracing and Perfetto
+        void WriteChromeTrace(std::ostream& output) const;
+
+    private:
+        std::chrono::steady_clock::time_point origin_;
+
+        mutable std::mutex mutex_;
+        std::vector<TraceEvent> events_;
+        std::vector<std::thread::id> threads_;
+    };
+
+    // spans of all threads are recorded into tracer until another one, or nullptr, is installed
+    // NOTE tracer should outlive spans started while it's installed
+    void InstallTracer(Tracer* tracer);
+    Tracer* InstalledTracer();
+
+    // A phase lasting from construction to destruction of the span, where spans nest by scope
+    // NOTE it costs an atomic load only if no tracer is installed
+    class TraceSpan : NonCopyable, NonMovable
+    {
+    public:
+        TraceSpan(const char* name, const char* category)
+            : tracer_(InstalledTracer()), name_(name), category_(category)
+        {
+            if (tracer_)
+                start_us_ = tracer_->Now();
+        }
+        ~TraceSpan()
+        {
+            if (tracer_)
+                tracer_->Record(TraceEvent{name_, category_, start_us_, tracer_->Now() - start_us_, 0, std::move(counters_)});
+        }
+
+        bool IsActive() const { return tracer_ != nullptr; }
+
+        // record a count of the phase, e.g. Count("states", pda->StateCount())
+        void Count(const char* name, int64_t value)
+        {
+            if (tracer_)
+                counters_.emplace_back(name, value);
+        }
+
+    private:
+        Tracer* tracer_;
+
+        const char* name_;
+        const char* category_;
+
+        double start_us_ = 0;
+
+        std::vector<std::pair<const char*, int64_t>> counters_ = {};
+    };
+}
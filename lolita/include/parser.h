@@ -1,8 +1,22 @@
 #pragma once
 #include "ast/ast-basic.h"
 #include "core/parsing-info.h"
+#include "core/compiled-grammar.h"
+#include "core/reduction-log.h"
+#include "core/ast-snapshot.h"
+#include "core/ast-compact.h"
+#include "core/incremental.h"
+#include "core/token-buffer.h"
+#include "core/parse-statistics.h"
 #include "memory/arena.h"
+#include "array-ref.h"
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <vector>
+#include <variant>
+#include <string_view>
+#include <type_traits>
 
 namespace eds::loli
 {
@@ -10,54 +24,286 @@ namespace eds::loli
     // BootstrapParser
     //
 
-    // generate code binding
-    std::string BootstrapParser(const std::string& config);
+    // generate code binding in namespace ns, which should be eds::loli or nested in it,
+    // e.g. to link bindings of several grammars into the same program
+    // NOTE it throws ParserConstructionError if a grammar binds actions, but some production
+    //      neither binds one nor forwards an item or enum, see SemanticActionHandler
+    std::string BootstrapParser(const std::string& config, const std::string& ns = "eds::loli");
 
     // =====================================================================================
-    // Parsing Actions
+    // Parsing Context
     //
 
-    struct ActionError
+    enum class ActionExecutionResult
     {
+        Hungry,
+        Consumed,
+        Error
     };
 
-    struct ActionShift
+    class ParsingContext;
+    class StatisticsContext;
+    struct TokenMapping;
+
+    // =====================================================================================
+    // Validation
+    //
+
+    enum class ParsingErrorKind
+    {
+        None,
+        InvalidToken,    // lexer fails to recognize any token
+        UnexpectedToken, // parser rejects a token
+        UnexpectedEof,   // parser rejects end of input
+    };
+
+    struct ValidationResult
+    {
+        bool accepted;
+
+        // offset where the first error is detected, -1 if accepted
+        // NOTE offset equals to length of input if it's unexpectedly exhausted
+        int error_offset;
+
+        ParsingErrorKind error_kind = ParsingErrorKind::None;
+
+        // rejected token, only valid for UnexpectedToken
+        ast::BasicAstToken error_token = {};
+
+        // parser state where the error is detected, -1 for InvalidToken or if accepted
+        int error_state = -1;
+    };
+
+    // result of a non-throwing parse
+    template <typename T>
+    struct ParsingResult
+    {
+        // only meaningful if accepted
+        T value;
+
+        ValidationResult status;
+
+        explicit operator bool() const { return status.accepted; }
+    };
+
+    // result of a parse with error recovery
+    template <typename T>
+    struct RecoveredParsingResult
+    {
+        // possibly partial tree, only meaningful if completed
+        T value;
+
+        // if end of input is accepted, possibly after recovery
+        bool completed;
+
+        // detected errors in order of offset
+        std::vector<ValidationResult> errors;
+    };
+
+    // results of parsing a batch of documents
+    template <typename T>
+    struct BatchParsingResult
     {
-        int target_state;
+        // in input order
+        std::vector<ParsingResult<T>> results;
+
+        // arenas where ASTs are allocated, one for each worker
+        std::vector<std::unique_ptr<Arena>> arenas;
     };
-    struct ActionReduce
+
+    // result of a parse split into chunks
+    template <typename T>
+    struct ParallelParsingResult
     {
-        const ProductionInfo* production;
+        // only meaningful if accepted
+        T value;
+
+        ValidationResult status;
+
+        // arenas where speculatively parsed chunks are allocated, besides the one passed in
+        std::vector<std::unique_ptr<Arena>> arenas;
+
+        // number of chunks the input is split into, and those failed to be speculated and parsed again serially
+        int chunk_count    = 0;
+        int reparsed_count = 0;
+
+        explicit operator bool() const { return status.accepted; }
     };
-    using ParsingAction = std::variant<ActionError, ActionShift, ActionReduce>;
 
     // =====================================================================================
-    // Parsing Context
+    // Parsing Events
     //
 
-    enum class ActionExecutionResult
+    // Callbacks for GenericParser::ParseEvents
+    // NOTE deriving from this class is not required, any type with these members would do,
+    //      and a final handler type gets its callbacks inlined into the parsing loop
+    class ParsingEventHandler
     {
-        Hungry,
-        Consumed,
-        Error
+    public:
+        virtual ~ParsingEventHandler() = default;
+
+        virtual void OnShift(const ast::BasicAstToken& tok) {}
+
+        // children are spans of right-hand side, span is {-1, -1} for an empty production
+        virtual void OnReduce(const ProductionInfo& production, ast::AstLocationInfo span, ArrayRef<ast::AstLocationInfo> children) {}
+
+        virtual void OnAccept() {}
+        virtual void OnError(int offset) {}
     };
 
-    class ParsingContext;
+    // a parsing context that forwards shift/reduce to a handler
+    template <typename Handler>
+    class ParsingEventContext
+    {
+    public:
+        ParsingEventContext(Handler& handler)
+            : handler_(handler) {}
+
+        int StackDepth() const
+        {
+            return state_stack_.size();
+        }
+        int CurrentState() const
+        {
+            return state_stack_.empty() ? 0 : state_stack_.back();
+        }
+
+        void ExecuteShift(int target_state, const ast::BasicAstToken& tok)
+        {
+            handler_.OnShift(tok);
+            ExecuteShift(target_state, ast::AstLocationInfo{tok.Offset(), tok.Length()});
+        }
+        void ExecuteShift(int target_state, ast::AstLocationInfo span)
+        {
+            state_stack_.push_back(target_state);
+            span_stack_.push_back(span);
+        }
+        ast::AstLocationInfo ExecuteReduce(const ProductionInfo& production)
+        {
+            // update state stack
+            const auto count = production.Right().size();
+            state_stack_.resize(state_stack_.size() - count);
+
+            // compute span
+            auto children = ArrayRef<ast::AstLocationInfo>(span_stack_.data(), span_stack_.size()).TakeBack(count);
+            auto span     = ast::CombineLocationInfo(children.Length(), [&](int i) { return children.At(i); });
+
+            handler_.OnReduce(production, span, children);
+
+            // update span stack
+            span_stack_.resize(span_stack_.size() - count);
+
+            return span;
+        }
+
+    private:
+        Handler& handler_;
+
+        std::vector<int> state_stack_                  = {};
+        std::vector<ast::AstLocationInfo> span_stack_ = {};
+    };
 
     // =====================================================================================
     // Parsing Context
     //
 
+    // NOTE tables of a GenericParser are immutable once initialized, so that const member functions
+    //      are safe to be called concurrently, provided that each thread works in its own arena
     class GenericParser
     {
     public:
-        GenericParser(const std::string& config, const ast::AstTypeProxyManager* env);
+        // see CompileGrammar for table_budget
+        GenericParser(const std::string& config, const ast::AstTypeProxyManager* env, size_t table_budget = 0);
+
+        // share a compiled grammar with other parsers, see LoadSharedGrammar
+        GenericParser(std::shared_ptr<const CompiledGrammar> grammar);
+
+        const auto& Grammar() const { return *grammar_; }
+        const auto& GrammarInfo() const { return grammar_->Info(); }
+
+        void Initialize(const std::string& config, const ast::AstTypeProxyManager* env, size_t table_budget = 0);
+
+        // bytes taken by each of runtime tables and the retained meta information
+        TableFootprint Footprint() const
+        {
+            return grammar_->Footprint();
+        }
+
+        // throws ParserInternalError on a rejected input
+        ast::AstItemWrapper Parse(Arena& arena, const std::string& data) const;
+
+        // same as Parse, except that a rejected input is reported in status
+        ParsingResult<ast::AstItemWrapper> TryParse(Arena& arena, const std::string& data) const;
+
+        // parse data as variable entry, which is either the root or declared as an entry of the grammar
+        // NOTE it throws ParserInternalError if entry is not a start symbol
+        ast::AstItemWrapper ParseAs(Arena& arena, const std::string& data, const std::string& entry) const;
+
+        // same as ParseAs, except that a rejected input is reported in status
+        ParsingResult<ast::AstItemWrapper> TryParseAs(Arena& arena, const std::string& data, const std::string& entry) const;
+
+        // parse in panic mode, which reports errors and carries on at sync tokens of the grammar
+        // NOTE a variable that fails to be parsed is left as an empty item in the tree
+        RecoveredParsingResult<ast::AstItemWrapper> ParseWithRecovery(Arena& arena, const std::string& data, int max_errors = 32) const;
 
-        const auto& GrammarInfo() const { return *info_; }
+        // construct AST with structurally identical klass objects shared
+        // NOTE it throws if any production assigns members of a selected object
+        ast::AstItemWrapper ParseInterned(Arena& arena, const std::string& data, ast::AstNodeInterner::Statistics* stats = nullptr) const;
 
-        void Initialize(const std::string& config, const ast::AstTypeProxyManager* env);
+        // validate input eagerly but only record shift/reduce sequence,
+        // AST nodes are constructed when materialized from the log
+        std::unique_ptr<ReductionLog> ParseLazy(const std::string& data) const;
 
-        ast::AstItemWrapper Parse(Arena& arena, const std::string& data);
+        // recognize input with a state stack only, no AST is constructed
+        ValidationResult Validate(std::string_view data) const;
+
+        // parse a long list at the top level of data concurrently, splitting it into chunks at split tokens of the grammar,
+        // where each chunk is speculated to start right after a complete list and parsed into a partial list to be merged,
+        // and a chunk is parsed again serially if the speculation turns out to be wrong
+        // NOTE it falls back to a serial parse if the grammar doesn't fit, e.g. no split token is declared
+        ParallelParsingResult<ast::AstItemWrapper> ParseParallel(Arena& arena, const std::string& data, int thread_count = 0) const;
+
+        // parse documents concurrently with thread_count workers, or as many as hardware threads if it's 0,
+        // where each worker takes the next document once it's done with one
+        // NOTE inputs are not copied and should be kept alive during parsing
+        BatchParsingResult<ast::AstItemWrapper> ParseBatch(ArrayRef<const std::string_view> inputs, int thread_count = 0) const;
+
+        // tokenize the whole text of buffer, see TokenBuffer
+        // NOTE on a rejected input, buffer is left invalid
+        ValidationResult Tokenize(TokenBuffer& buffer) const;
+
+        // replace removed_length characters at offset in buffer with inserted and relex affected tokens only,
+        // see TokenBuffer::LastDamage for tokens replaced
+        ValidationResult Retokenize(TokenBuffer& buffer, int offset, int removed_length, std::string_view inserted) const;
+
+        // parse the whole text of doc, see IncrementalDocument
+        // NOTE on a rejected input, tree of doc is dropped
+        ValidationResult ParseDocument(IncrementalDocument& doc) const;
+
+        // replace removed_length characters at offset in doc with inserted and reparse it,
+        // where subtrees whose tokens, left context and lookahead are unchanged are shared with the previous tree
+        ValidationResult Reparse(IncrementalDocument& doc, int offset, int removed_length, std::string_view inserted) const;
+
+#ifdef LOLITA_PARSE_STATISTICS
+        // same as TryParse, also accumulating counters of the parse into stats
+        // NOTE stats is only available if lolita is built with LOLITA_PARSE_STATISTICS
+        ParsingResult<ast::AstItemWrapper> TryParseWithStatistics(Arena& arena, const std::string& data, ParseStatistics& stats) const;
+#endif
+
+        // stream shift/reduce events of a parse into handler, no AST is constructed
+        template <typename Handler>
+        ValidationResult ParseEvents(std::string_view data, Handler& handler) const
+        {
+            ParsingEventContext<Handler> ctx{handler};
+
+            auto result = ProcessInput(ctx, data);
+            if (result.accepted)
+                handler.OnAccept();
+            else
+                handler.OnError(result.error_offset);
+
+            return result;
+        }
 
     private:
         int LexerInitialState() const { return 0; }
@@ -65,71 +311,353 @@ namespace eds::loli
 
         bool VerifyCharacter(int ch) const
         {
-            return ch >= 0 && ch < 128;
+            return grammar_->VerifyCharacter(ch);
         }
         bool VerifyLexingState(int state) const
         {
-            return state >= 0 && state < dfa_state_num_;
+            return grammar_->VerifyLexingState(state);
         }
         bool VerifyParsingState(int state) const
         {
-            return state >= 0 && state < pda_state_num_;
+            return grammar_->VerifyParsingState(state);
+        }
+        bool IsSyncToken(int term_id) const
+        {
+            return grammar_->IsSyncToken(term_id);
+        }
+        bool IsSplitToken(int term_id) const
+        {
+            return grammar_->IsSplitToken(term_id);
+        }
+        bool IsAcceptingVariable(int nonterm_id) const
+        {
+            return grammar_->IsAcceptingVariable(nonterm_id);
         }
 
         int LookupLexingTransition(int state, int ch) const
         {
-            assert(VerifyLexingState(state) && VerifyCharacter(ch));
-            return lexing_table_[128 * state + ch];
+            return grammar_->LookupLexingTransition(state, ch);
         }
         const TokenInfo* LookupAcceptedToken(int state) const
         {
-            assert(VerifyLexingState(state));
-            return acc_token_lookup_[state];
+            return grammar_->LookupAcceptedToken(state);
         }
         ParsingAction LookupParsingAction(int state, int term_id) const
         {
-            assert(VerifyParsingState(state) && term_id >= 0 && term_id < term_num_);
-            return action_table_[term_num_ * state + term_id];
+            return grammar_->LookupParsingAction(state, term_id);
         }
         ParsingAction LookupParsingActionOnEof(int state) const
         {
-            assert(VerifyParsingState(state));
-            return eof_action_table_[state];
+            return grammar_->LookupParsingActionOnEof(state);
         }
         int LookupParsingGoto(int state, int nonterm_id) const
         {
-            assert(VerifyParsingState(state) && nonterm_id >= 0 && nonterm_id <= nonterm_num_);
-            return goto_table_[nonterm_num_ * state + nonterm_id];
+            return grammar_->LookupParsingGoto(state, nonterm_id);
         }
 
-        ast::BasicAstToken LoadToken(std::string_view data, int offset);
+        ast::BasicAstToken LoadToken(std::string_view data, int offset) const;
 
-        ActionExecutionResult ForwardParsingAction(ParsingContext& ctx, ActionShift action, const ast::BasicAstToken& tok);
-        ActionExecutionResult ForwardParsingAction(ParsingContext& ctx, ActionReduce action, const ast::BasicAstToken& tok);
-        ActionExecutionResult ForwardParsingAction(ParsingContext& ctx, ActionError action, const ast::BasicAstToken& tok);
+        // same as above, also reporting the position following the last character examined in scan_end
+        ast::BasicAstToken LoadToken(std::string_view data, int offset, int& scan_end) const;
 
-        void FeedParsingContext(ParsingContext& ctx, const ast::BasicAstToken& tok);
+        // relex tokens in buffer from first, until a new token is identical to an old one at or after damage_end,
+        // which is then moved by delta characters along with tokens following it
+        ValidationResult RelexTokens(TokenBuffer& buffer, int first, int damage_end, int delta) const;
 
-    private:
-        // meta information
-        std::unique_ptr<ParsingMetaInfo> info_;
+        // parse tokens of doc, reusing nodes of its current tree where mapping allows
+        ValidationResult ParseDocumentTokens(IncrementalDocument& doc, const TokenMapping& mapping) const;
+
+        // NOTE Context could be any type of parsing context, see ParsingEventContext and parser.cpp
+        template <typename Context>
+        ActionExecutionResult ForwardParsingAction(Context& ctx, ActionShift action, const ast::BasicAstToken& tok) const;
+        template <typename Context>
+        ActionExecutionResult ForwardParsingAction(Context& ctx, ActionReduce action, const ast::BasicAstToken& tok) const;
+        template <typename Context>
+        ActionExecutionResult ForwardParsingAction(Context& ctx, ActionError action, const ast::BasicAstToken& tok) const;
+
+        // returns false if tok is rejected
+        template <typename Context>
+        bool FeedParsingContext(Context& ctx, const ast::BasicAstToken& tok) const;
+
+        // tokenize data and feed the context until eof is accepted or an error is detected
+        template <typename Context>
+        ValidationResult ProcessInput(Context& ctx, std::string_view data) const;
+
+        // pop the context until tok is acceptable, either directly or after an error node is inserted,
+        // returns false and leaves the context untouched if no such state is found
+        // NOTE Context should support StateAt, ExecutePop and ExecuteRecover
+        template <typename Context>
+        bool RecoverParsingContext(Context& ctx, const ast::BasicAstToken& tok) const;
 
-        // parser
-        int token_num_;
-        int term_num_;
-        int nonterm_num_;
+        // same as ProcessInput, except that tokens are skipped after an error until
+        // the context could be recovered at a sync token, returns true if eof is accepted
+        template <typename Context>
+        bool ProcessInputWithRecovery(Context& ctx, std::string_view data, std::vector<ValidationResult>& errors, int max_errors) const;
 
-        int dfa_state_num_;
-        int pda_state_num_;
+        // reduce on lookahead until the context is left with a single list variable in boundary_state,
+        // where the list itself is reduced in place but never folded into anything else
+        template <typename Context>
+        bool ReduceToBoundary(Context& ctx, const ast::BasicAstToken& lookahead, const VariableInfo* list, int boundary_state) const;
 
-        container::HeapArray<const TokenInfo*> acc_token_lookup_; // 1 column, token_num_ rows
-        container::HeapArray<int> lexing_table_;                  // 128 columns, dfa_state_num_ rows
+        // throw for a failed ValidationResult
+        [[noreturn]] void ThrowParsingError(const ValidationResult& result) const;
 
-        container::HeapArray<ParsingAction> action_table_;     // term_num_ columns, pda_state_num_ rows
-        container::HeapArray<ParsingAction> eof_action_table_; // 1 column, pda_state_num_ rows
-        container::HeapArray<int> goto_table_;                 // nonterm_num_ columns, pda_state_num_ rows
+    private:
+        // tables and meta information, which may be shared among parsers
+        std::shared_ptr<const CompiledGrammar> grammar_;
     };
 
+    // =====================================================================================
+    // Implementation of Parsing Driver
+    //
+
+    template <typename Context>
+    ValidationResult GenericParser::ProcessInput(Context& ctx, std::string_view data) const
+    {
+        int offset = 0;
+
+        // tokenize and feed parser while not exhausted
+        while (offset < data.length())
+        {
+#ifdef LOLITA_PARSE_STATISTICS
+            auto tok = ast::BasicAstToken{};
+            if constexpr (std::is_same_v<Context, StatisticsContext>)
+            {
+                int scan_end;
+                tok = LoadToken(data, offset, scan_end);
+                ctx.RecordToken(tok, offset, std::min<int>(scan_end, data.length()), tok.IsValid() && tok.Tag() >= grammar_->TermCount());
+            }
+            else
+            {
+                tok = LoadToken(data, offset);
+            }
+#else
+            auto tok = LoadToken(data, offset);
+#endif
+
+            // report invalid token
+            if (!tok.IsValid())
+                return ValidationResult{false, offset, ParsingErrorKind::InvalidToken};
+
+            // update offset
+            offset = tok.Offset() + tok.Length();
+
+            // ignore tokens in blacklist
+            if (tok.Tag() >= grammar_->TermCount())
+                continue;
+
+            if (!FeedParsingContext(ctx, tok))
+                return ValidationResult{false, tok.Offset(), ParsingErrorKind::UnexpectedToken, tok, ctx.CurrentState()};
+        }
+
+        // finalize parsing
+        if (!FeedParsingContext(ctx, {}))
+            return ValidationResult{false, static_cast<int>(data.length()), ParsingErrorKind::UnexpectedEof, {}, ctx.CurrentState()};
+
+        return ValidationResult{true, -1};
+    }
+
+    template <typename Context>
+    bool GenericParser::RecoverParsingContext(Context& ctx, const ast::BasicAstToken& tok) const
+    {
+        auto acceptable = [&](int state) {
+            auto action = tok.IsValid()
+                              ? LookupParsingAction(state, tok.Tag())
+                              : LookupParsingActionOnEof(state);
+
+            return !std::holds_alternative<ActionError>(action);
+        };
+
+        auto pop_to = [&](int depth) {
+            while (ctx.StackDepth() > depth)
+                ctx.ExecutePop();
+        };
+
+        // search from the topmost state
+        for (int depth = ctx.StackDepth(); depth >= 0; --depth)
+        {
+            auto state = depth > 0 ? ctx.StateAt(depth - 1) : ParserInitialState();
+
+            // resume directly
+            if (acceptable(state))
+            {
+                pop_to(depth);
+                return true;
+            }
+
+            // resume after a variable is assumed, the innermost one first
+            for (auto nonterm_id : grammar_->RecoveryVariables())
+            {
+                auto target_state = LookupParsingGoto(state, nonterm_id);
+                if (target_state != -1 && acceptable(target_state))
+                {
+                    pop_to(depth);
+                    ctx.ExecuteRecover(target_state, grammar_->Info().Variables()[nonterm_id], *grammar_->Info().Environment());
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    template <typename Context>
+    bool GenericParser::ProcessInputWithRecovery(Context& ctx, std::string_view data, std::vector<ValidationResult>& errors, int max_errors) const
+    {
+        int offset    = 0;
+        bool skipping = false;
+
+        // tokenize and feed parser while not exhausted
+        while (offset < data.length())
+        {
+            auto tok = LoadToken(data, offset);
+
+            // report invalid token and skip a character
+            if (!tok.IsValid())
+            {
+                if (!skipping)
+                {
+                    errors.push_back(ValidationResult{false, offset, ParsingErrorKind::InvalidToken});
+                    if (errors.size() >= max_errors)
+                        return false;
+
+                    skipping = true;
+                }
+
+                offset += 1;
+                continue;
+            }
+
+            // update offset
+            offset = tok.Offset() + tok.Length();
+
+            // ignore tokens in blacklist
+            if (tok.Tag() >= grammar_->TermCount())
+                continue;
+
+            // in panic mode, resume at a sync token where the context could be recovered
+            // NOTE errors right after recovery are not reported
+            if (skipping)
+            {
+                if (IsSyncToken(tok.Tag()) && RecoverParsingContext(ctx, tok))
+                {
+                    skipping = !FeedParsingContext(ctx, tok);
+                }
+
+                continue;
+            }
+
+            if (!FeedParsingContext(ctx, tok))
+            {
+                errors.push_back(ValidationResult{false, tok.Offset(), ParsingErrorKind::UnexpectedToken, tok, ctx.CurrentState()});
+                if (errors.size() >= max_errors)
+                    return false;
+
+                // rejected token could be a sync token as well
+                skipping = !(IsSyncToken(tok.Tag()) && RecoverParsingContext(ctx, tok) && FeedParsingContext(ctx, tok));
+            }
+        }
+
+        // finalize parsing
+        if (skipping)
+        {
+            return RecoverParsingContext(ctx, {}) && FeedParsingContext(ctx, {});
+        }
+        else if (!FeedParsingContext(ctx, {}))
+        {
+            errors.push_back(ValidationResult{false, static_cast<int>(data.length()), ParsingErrorKind::UnexpectedEof, {}, ctx.CurrentState()});
+
+            return RecoverParsingContext(ctx, {}) && FeedParsingContext(ctx, {});
+        }
+
+        return true;
+    }
+
+    template <typename Context>
+    bool GenericParser::ReduceToBoundary(Context& ctx, const ast::BasicAstToken& lookahead, const VariableInfo* list, int boundary_state) const
+    {
+        auto lookup = [&]() {
+            return lookahead.IsValid()
+                       ? LookupParsingAction(ctx.CurrentState(), lookahead.Tag())
+                       : LookupParsingActionOnEof(ctx.CurrentState());
+        };
+
+        for (auto action = lookup(); std::holds_alternative<ActionReduce>(action); action = lookup())
+        {
+            const auto& reduce = std::get<ActionReduce>(action);
+
+            // a reduction folding the list at the bottom must produce the list again,
+            // while the first chunk is folded from the initial state as usual
+            const auto depth      = ctx.StackDepth();
+            const auto folds_list = depth > 0 && reduce.production->Right().size() >= depth && ctx.StateAt(0) == boundary_state;
+            if (folds_list && reduce.production->Left() != list)
+                break;
+
+            ForwardParsingAction(ctx, reduce, lookahead);
+        }
+
+        return ctx.StackDepth() == 1 && ctx.CurrentState() == boundary_state;
+    }
+
+    template <typename Context>
+    ActionExecutionResult GenericParser::ForwardParsingAction(Context& ctx, ActionShift action, const ast::BasicAstToken& tok) const
+    {
+        assert(tok.IsValid());
+
+        ctx.ExecuteShift(action.target_state, tok);
+        return ActionExecutionResult::Consumed;
+    }
+    template <typename Context>
+    ActionExecutionResult GenericParser::ForwardParsingAction(Context& ctx, ActionReduce action, const ast::BasicAstToken& tok) const
+    {
+        auto folded = ctx.ExecuteReduce(*action.production);
+
+        auto nonterm_id   = action.production->Left()->Id();
+        auto src_state    = ctx.CurrentState();
+        auto target_state = LookupParsingGoto(src_state, nonterm_id);
+
+        ctx.ExecuteShift(target_state, folded);
+
+        if (!tok.IsValid() &&
+            ctx.StackDepth() == 1 &&
+            IsAcceptingVariable(nonterm_id))
+        {
+            return ActionExecutionResult::Consumed;
+        }
+        else
+        {
+            return ActionExecutionResult::Hungry;
+        }
+    }
+    template <typename Context>
+    ActionExecutionResult GenericParser::ForwardParsingAction(Context& ctx, ActionError action, const ast::BasicAstToken& tok) const
+    {
+        return ActionExecutionResult::Error;
+    }
+
+    template <typename Context>
+    bool GenericParser::FeedParsingContext(Context& ctx, const ast::BasicAstToken& tok) const
+    {
+        while (true)
+        {
+            auto cur_state = ctx.CurrentState();
+            auto action    = tok.IsValid()
+                              ? LookupParsingAction(cur_state, tok.Tag())
+                              : LookupParsingActionOnEof(cur_state);
+
+            auto action_result = std::visit([&](auto x) { return ForwardParsingAction(ctx, x, tok); }, action);
+
+            if (action_result == ActionExecutionResult::Error)
+            {
+                return false;
+            }
+            else if (action_result == ActionExecutionResult::Consumed)
+            {
+                return true;
+            }
+        }
+    }
+
     template <typename T>
     class BasicParser
     {
@@ -137,22 +665,196 @@ namespace eds::loli
         using Ptr        = std::unique_ptr<BasicParser>;
         using ResultType = typename ast::AstTypeTrait<T>::StoreType;
 
-        ResultType Parse(Arena& arena, const std::string& data)
+        const auto& GrammarInfo() const { return parser_->GrammarInfo(); }
+
+        ResultType Parse(Arena& arena, const std::string& data) const
         {
-            auto result = parser_->Parse(*arena, data);
+            auto result = parser_->Parse(arena, data);
 
             return result.Extract<ResultType>();
         }
 
-        static Ptr Create(const std::string& config, const ast::AstTypeProxyManager* env)
+        ParsingResult<ResultType> TryParse(Arena& arena, const std::string& data) const
+        {
+            auto result = parser_->TryParse(arena, data);
+            if (!result)
+                return ParsingResult<ResultType>{ResultType{}, result.status};
+
+            return ParsingResult<ResultType>{result.value.Extract<ResultType>(), result.status};
+        }
+
+#ifdef LOLITA_PARSE_STATISTICS
+        ParsingResult<ResultType> TryParseWithStatistics(Arena& arena, const std::string& data, ParseStatistics& stats) const
+        {
+            auto result = parser_->TryParseWithStatistics(arena, data, stats);
+            if (!result)
+                return ParsingResult<ResultType>{ResultType{}, result.status};
+
+            return ParsingResult<ResultType>{result.value.Extract<ResultType>(), result.status};
+        }
+#endif
+
+        // parse data as start symbol entry typed U, e.g. ParseAs<Expression>(arena, "1+2"),
+        // where entry could be omitted if it's the only start symbol typed U
+        template <typename U>
+        typename ast::AstTypeTrait<U>::StoreType ParseAs(Arena& arena, const std::string& data, const std::string& entry = "") const
+        {
+            auto result = parser_->ParseAs(arena, data, entry.empty() ? LookupEntryOf<U>() : entry);
+
+            return result.template Extract<typename ast::AstTypeTrait<U>::StoreType>();
+        }
+
+        template <typename U>
+        ParsingResult<typename ast::AstTypeTrait<U>::StoreType> TryParseAs(Arena& arena, const std::string& data, const std::string& entry = "") const
+        {
+            using StoreType = typename ast::AstTypeTrait<U>::StoreType;
+
+            auto result = parser_->TryParseAs(arena, data, entry.empty() ? LookupEntryOf<U>() : entry);
+            if (!result)
+                return ParsingResult<StoreType>{StoreType{}, result.status};
+
+            return ParsingResult<StoreType>{result.value.template Extract<StoreType>(), result.status};
+        }
+
+        RecoveredParsingResult<ResultType> ParseWithRecovery(Arena& arena, const std::string& data, int max_errors = 32) const
+        {
+            auto result = parser_->ParseWithRecovery(arena, data, max_errors);
+            auto value  = result.value.HasValue() ? result.value.Extract<ResultType>() : ResultType{};
+
+            return RecoveredParsingResult<ResultType>{value, result.completed, std::move(result.errors)};
+        }
+
+        ResultType ParseInterned(Arena& arena, const std::string& data, ast::AstNodeInterner::Statistics* stats = nullptr) const
+        {
+            auto result = parser_->ParseInterned(arena, data, stats);
+
+            return result.Extract<ResultType>();
+        }
+
+        std::unique_ptr<ReductionLog> ParseLazy(const std::string& data) const
+        {
+            return parser_->ParseLazy(data);
+        }
+
+        ValidationResult Validate(std::string_view data) const
+        {
+            return parser_->Validate(data);
+        }
+
+        ParallelParsingResult<ResultType> ParseParallel(Arena& arena, const std::string& data, int thread_count = 0) const
+        {
+            auto result = parser_->ParseParallel(arena, data, thread_count);
+            auto value  = result ? result.value.Extract<ResultType>() : ResultType{};
+
+            return ParallelParsingResult<ResultType>{value, result.status, std::move(result.arenas), result.chunk_count, result.reparsed_count};
+        }
+
+        BatchParsingResult<ResultType> ParseBatch(ArrayRef<const std::string_view> inputs, int thread_count = 0) const
+        {
+            auto batch  = parser_->ParseBatch(inputs, thread_count);
+            auto result = BatchParsingResult<ResultType>{{}, std::move(batch.arenas)};
+
+            for (auto& item : batch.results)
+            {
+                auto value = item ? item.value.Extract<ResultType>() : ResultType{};
+                result.results.push_back(ParsingResult<ResultType>{value, item.status});
+            }
+
+            return result;
+        }
+
+        ValidationResult Tokenize(TokenBuffer& buffer) const
+        {
+            return parser_->Tokenize(buffer);
+        }
+
+        ValidationResult Retokenize(TokenBuffer& buffer, int offset, int removed_length, std::string_view inserted) const
+        {
+            return parser_->Retokenize(buffer, offset, removed_length, inserted);
+        }
+
+        ValidationResult ParseDocument(IncrementalDocument& doc) const
+        {
+            return parser_->ParseDocument(doc);
+        }
+
+        ValidationResult Reparse(IncrementalDocument& doc, int offset, int removed_length, std::string_view inserted) const
+        {
+            return parser_->Reparse(doc, offset, removed_length, inserted);
+        }
+
+        template <typename Handler>
+        ValidationResult ParseEvents(std::string_view data, Handler& handler) const
+        {
+            return parser_->ParseEvents(data, handler);
+        }
+
+        // deep-copy a parsed AST into arena in traversal order
+        ResultType Compact(Arena& arena, ResultType root) const
+        {
+            ast::AstItemWrapper result = CompactAst(parser_->GrammarInfo(), arena, root);
+
+            return result.Extract<ResultType>();
+        }
+
+        std::vector<int32_t> SaveSnapshot(ResultType root) const
+        {
+            return SaveAstSnapshot(parser_->GrammarInfo(), root);
+        }
+
+        ResultType LoadSnapshot(Arena& arena, ArrayRef<const int32_t> data) const
+        {
+            auto result = LoadAstSnapshot(parser_->GrammarInfo(), arena, data);
+
+            return result.Extract<ResultType>();
+        }
+
+        TableFootprint Footprint() const
+        {
+            return parser_->Footprint();
+        }
+
+        // see CompileGrammar for table_budget
+        // NOTE parsers created with the same arguments share a single compiled grammar, see LoadSharedGrammar
+        static Ptr Create(const std::string& config, const ast::AstTypeProxyManager* env, size_t table_budget = 0)
         {
             auto result     = std::make_unique<BasicParser<T>>();
-            result->parser_ = std::make_unique<GenericParser>(config, env);
+            result->parser_ = std::make_unique<GenericParser>(LoadSharedGrammar(config, env, table_budget));
 
             return result;
         }
 
     private:
+        // name of the only start symbol typed U without qualifier
+        template <typename U>
+        std::string LookupEntryOf() const
+        {
+            const auto& info      = parser_->GrammarInfo();
+            const auto& type_name = info.Environment()->LookupName(typeid(U));
+
+            auto result    = std::string{};
+            auto try_match = [&](const VariableInfo& var) {
+                if (var.Type().IsNoneQualified() && var.Type().type->Name() == type_name)
+                {
+                    if (!result.empty())
+                        throw ParserInternalError{"BasicParser: multiple start symbols of the type, entry should be specified"};
+
+                    result = var.Name();
+                }
+            };
+
+            try_match(info.RootVariable());
+            for (const auto& entry : info.Entries())
+            {
+                try_match(*entry.variable);
+            }
+
+            if (result.empty())
+                throw ParserInternalError{"BasicParser: no start symbol of the type"};
+
+            return result;
+        }
+
         std::unique_ptr<GenericParser> parser_;
     };
 }
\ No newline at end of file
@@ -110,6 +110,9 @@ namespace eds::loli::parsing
     {
     public:
         const auto& RootSymbol() const { return root_symbol_; }
+
+        // augmented symbols of additional start symbols, which precede eof as root does
+        const auto& EntrySymbols() const { return entry_symbols_; }
         const auto& Terminals() const { return terms_; }
         const auto& Nonterminals() const { return nonterms_; }
         const auto& Productions() const { return productions_; }
@@ -121,6 +124,7 @@ namespace eds::loli::parsing
         friend class GrammarBuilder;
 
         Nonterminal* root_symbol_;
+        std::vector<Nonterminal*> entry_symbols_;
 
         std::map<SymbolKey, Terminal> terms_;
         std::map<SymbolKey, Nonterminal> nonterms_;
@@ -137,7 +141,7 @@ namespace eds::loli::parsing
 
         void CreateProduction(const ProductionInfo* info, Nonterminal* lhs, const SymbolVec& rhs);
 
-        std::unique_ptr<Grammar> Build(Nonterminal* root);
+        std::unique_ptr<Grammar> Build(Nonterminal* root, const std::vector<Nonterminal*>& entries = {});
 
     private:
         void ComputeFirstSet();
@@ -1,8 +1,9 @@
 #pragma once
 #include "core/parsing-info.h"
-#include "container/flat-set.h"
+#include "array-ref.h"
+#include <cstdint>
 #include <vector>
-#include <map>
+#include <deque>
 #include <variant>
 #include <optional>
 #include <memory>
@@ -20,19 +21,6 @@ namespace eds::loli::parsing
     class ParsingItem
     {
     public:
-        struct Less
-        {
-            bool operator()(const ParsingItem& lhs, const ParsingItem& rhs)
-            {
-                if (lhs.production_ < rhs.production_)
-                    return true;
-                if (lhs.production_ > rhs.production_)
-                    return false;
-
-                return lhs.cursor_ < rhs.cursor_;
-            }
-        };
-
         ParsingItem(const ProductionInfo* p, int cursor)
             : production_(p), cursor_(cursor)
         {
@@ -77,7 +65,24 @@ namespace eds::loli::parsing
         int cursor_;
     };
 
-    using ItemSet = FlatSet<ParsingItem, ParsingItem::Less>;
+    // ParsingItem packed into 32 bits, i.e. id of its production in high bits and its cursor in low bits,
+    // so that items of the same production are adjacent in order of cursor
+    // NOTE a grammar should fit in the bits, see VerifyItemPacking
+    using PackedItem = uint32_t;
+
+    inline constexpr int item_cursor_bits = 10;
+
+    inline PackedItem PackItem(ParsingItem item)
+    {
+        return (static_cast<PackedItem>(item.Production()->Id()) << item_cursor_bits) | static_cast<PackedItem>(item.Cursor());
+    }
+    inline ParsingItem UnpackItem(const ParsingMetaInfo& info, PackedItem item)
+    {
+        return ParsingItem{&info.Productions()[item >> item_cursor_bits], static_cast<int>(item & ((1u << item_cursor_bits) - 1))};
+    }
+
+    // kernel items of a ParsingState, which are packed, sorted and unique
+    using ItemKernel = ArrayRef<const PackedItem>;
 
     // ==============================================================
     // Parsing Actions
@@ -125,6 +130,8 @@ namespace eds::loli::parsing
     // Parsing Automaton
     //
 
+    // States of an LR automaton identified by their kernels, which are interned in a pool
+    // and looked up by hash in an open addressing table
     class ParsingAutomaton
     {
     public:
@@ -134,17 +141,44 @@ namespace eds::loli::parsing
         }
         const ParsingState* LookupState(int id) const
         {
-            return ptrs_.at(id);
+            return &states_.at(id);
+        }
+        ParsingState* LookupState(int id)
+        {
+            return &states_.at(id);
+        }
+
+        // NOTE it's invalidated once a new state is made
+        ItemKernel LookupKernel(int id) const
+        {
+            assert(id >= 0 && id < StateCount());
+            return ItemKernel(kernel_pool_.data() + kernel_offsets_[id], kernel_offsets_[id + 1] - kernel_offsets_[id]);
         }
 
-        const auto States() const { return states_; }
+        // lookup the state of kernel, or create it with the next id if not found,
+        // where the flag tells if it's newly created
+        // NOTE kernel is copied into the pool, so it should not be one from LookupKernel
+        std::pair<ParsingState*, bool> MakeState(ItemKernel kernel);
 
-        ParsingState* MakeState(const ItemSet& items);
-        void EnumerateState(std::function<void(const ItemSet&, ParsingState&)> callback);
+        // enumerate states in order of id
+        void EnumerateState(std::function<void(ItemKernel, ParsingState&)> callback);
 
     private:
-        std::vector<ParsingState*> ptrs_;
-        std::map<ItemSet, ParsingState> states_;
+        // double slots and reinsert all states
+        void GrowSlots();
+
+    private:
+        // NOTE deque keeps states in place as it grows
+        std::deque<ParsingState> states_;
+
+        // kernel of state id is kernel_pool_[kernel_offsets_[id], kernel_offsets_[id + 1])
+        std::vector<PackedItem> kernel_pool_;
+        std::vector<int> kernel_offsets_ = {0};
+        std::vector<size_t> kernel_hashes_;
+
+        // ids of states at the slot of their kernel hash with linear probing, or -1 if empty
+        // NOTE its size is a power of 2 and kept at least twice the number of states
+        std::vector<int> slots_;
     };
 
     std::unique_ptr<const ParsingAutomaton> BuildSLRAutomaton(const ParsingMetaInfo& info);
@@ -1,5 +1,6 @@
 #include "lexing/lexing-automaton.h"
 #include "core/regex.h"
+#include "core/trace.h"
 #include "container/flat-set.h"
 #include "text/text-utils.h"
 #include <algorithm>
@@ -240,9 +241,14 @@ namespace eds::loli::lexing
 
     unique_ptr<const LexingAutomaton> BuildDfaAutomaton(const JointRegexTree& trees)
     {
+        TraceSpan span{"BuildDfaAutomaton", "construction"};
+
         // analyze regex trees
         auto eval_result = CollectRegexNodeInfo(trees.roots);
 
+        int64_t position_set_count = 0;
+        int64_t transition_count   = 0;
+
         // NOTE a set of positions of regex node coresponds to a Dfa state
         auto initial_state = ComputeInitialPositionSet(eval_result, trees.roots);
 
@@ -259,6 +265,7 @@ namespace eds::loli::lexing
             {
                 // construct the target position set
                 auto dest_set = ComputeTargetPositionSet(eval_result, src_set, ch);
+                position_set_count += 1;
 
                 // skip empty state, that's invalid
                 if (dest_set.empty())
@@ -282,9 +289,14 @@ namespace eds::loli::lexing
 
                 // update DFA transition table
                 dfa->NewTransition(src_state, dest_state, ch);
+                transition_count += 1;
             }
         }
 
+        span.Count("states", dfa->StateCount());
+        span.Count("transitions", transition_count);
+        span.Count("position_sets", position_set_count);
+
         return dfa;
     }
 
@@ -316,6 +328,8 @@ namespace eds::loli::lexing
 
     std::unique_ptr<const LexingAutomaton> BuildLexingAutomaton(const ParsingMetaInfo& info)
     {
+        TraceSpan span{"BuildLexingAutomaton", "construction"};
+
         auto joint_regex = PrepareRegexBatch(info);
         auto dfa         = BuildDfaAutomaton(joint_regex);
 
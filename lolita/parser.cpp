@@ -1,10 +1,14 @@
 #include "parser.h"
 #include "core/codegen.h"
-#include "lexing/lexing-automaton.h"
-#include "parsing/parsing-automaton.h"
+#include "core/trace.h"
 #include <vector>
 #include <string>
 #include <variant>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <chrono>
 
 using namespace std;
 using namespace eds::container;
@@ -16,7 +20,7 @@ namespace eds::loli
     // Implementation of BootstrapParser
     //
 
-    std::string BootstrapParser(const string& config)
+    std::string BootstrapParser(const string& config, const string& ns)
     {
         auto info = ResolveParsingInfo(config, nullptr);
 
@@ -31,7 +35,7 @@ namespace eds::loli
         e.Include("lolita-include.h", false);
 
         e.EmptyLine();
-        e.Namespace("eds::loli", [&]() {
+        e.Namespace(ns, [&]() {
 
             //====================================================
             e.EmptyLine();
@@ -95,9 +99,21 @@ namespace eds::loli
                 e.Class(base_def.Name(), "public BasicAstObject", [&]() {
                     e.WriteLine("public:");
 
+                    // kind tag
+                    e.Enum("class Kind", "", [&]() {
+                        for (const auto& klass_def : info->Klasses())
+                        {
+                            if (klass_def.BaseType() == &base_def)
+                            {
+                                e.WriteLine("{},", klass_def.Name());
+                            }
+                        }
+                    });
+
                     // visitor
+                    e.EmptyLine();
                     e.Struct("Visitor", "", [&]() {
-                        for (auto klass_def : info->Klasses())
+                        for (const auto& klass_def : info->Klasses())
                         {
                             if (klass_def.BaseType() == &base_def)
                             {
@@ -106,9 +122,26 @@ namespace eds::loli
                         }
                     });
 
+                    // constructor
+                    e.EmptyLine();
+                    e.WriteLine("{}(Kind kind) : kind_(kind) {{}}", base_def.Name());
+
+                    // kind accessor
+                    e.EmptyLine();
+                    e.WriteLine("Kind GetKind() const {{ return kind_; }}");
+
                     // accept
                     e.EmptyLine();
                     e.WriteLine("virtual void Accept(Visitor&) = 0;");
+
+                    // static dispatch, defined after klasses
+                    e.EmptyLine();
+                    e.WriteLine("template <typename F>");
+                    e.WriteLine("decltype(auto) Visit(F&& f);");
+
+                    e.EmptyLine();
+                    e.WriteLine("private:");
+                    e.WriteLine("Kind kind_;");
                 });
             }
 
@@ -164,6 +197,12 @@ namespace eds::loli
                 e.Class(klass_def.Name(), inh, [&]() {
                     e.WriteLine("public:");
 
+                    if (base)
+                    {
+                        e.WriteLine("{}() : {}(Kind::{}) {{}}", klass_def.Name(), base->Name(), klass_def.Name());
+                        e.EmptyLine();
+                    }
+
                     int index = 0;
                     for (const auto& member : klass_def.Members())
                     {
@@ -178,6 +217,32 @@ namespace eds::loli
                 });
             }
 
+            //====================================================
+            e.EmptyLine();
+            e.Comment("Static dispatch");
+            e.Comment("");
+
+            e.EmptyLine();
+            for (const auto& base_def : info->Bases())
+            {
+                e.WriteLine("template <typename F>");
+                e.Block(text::Format("inline decltype(auto) {}::Visit(F&& f)", base_def.Name()), [&]() {
+                    e.Block("switch (kind_)", [&]() {
+                        for (const auto& klass_def : info->Klasses())
+                        {
+                            if (klass_def.BaseType() == &base_def)
+                            {
+                                e.WriteLine("case Kind::{}:", klass_def.Name());
+                                e.WriteLine("    return std::forward<F>(f)(static_cast<{}&>(*this));", klass_def.Name());
+                            }
+                        }
+
+                        e.WriteLine("default:");
+                        e.WriteLine("    throw ParserInternalError{{\"{}: invalid node kind\"}};", base_def.Name());
+                    });
+                });
+            }
+
             //====================================================
             e.EmptyLine();
             e.Comment("Environment");
@@ -185,7 +250,7 @@ namespace eds::loli
 
             e.EmptyLine();
             auto rootName = info->RootVariable().Type().type->Name();
-            auto funcName = text::Format("inline BasicParser<{}>::Ptr CreateParser()", rootName);
+            auto funcName = text::Format("inline BasicParser<{}>::Ptr CreateParser(size_t table_budget = 0)", rootName);
             e.Block(funcName, [&]() {
                 // config
                 e.WriteLine("static const auto config = \nu8R\"##########(\n{}\n)##########\";", config);
@@ -225,7 +290,181 @@ namespace eds::loli
 
                 // parser
                 e.EmptyLine();
-                e.WriteLine("return BasicParser<{}>::Create(config, &proxy_manager);", rootName);
+                e.WriteLine("return BasicParser<{}>::Create(config, &proxy_manager, table_budget);", rootName);
+            });
+
+            //====================================================
+            // only for grammars binding any action
+            auto has_action = any_of(info->Productions().begin(), info->Productions().end(),
+                                     [](const auto& production) { return !production.Action().empty(); });
+            if (!has_action)
+                return;
+
+            e.EmptyLine();
+            e.Comment("Semantic actions");
+            e.Comment("");
+
+            // member type of Actions holding values of a variable type, e.g. Expression or StatementVec
+            auto value_type_name = [](const TypeSpec& type) {
+                auto name = type.type->Name();
+                if (type.IsVector())
+                    name.append("Vec");
+                else if (type.IsOptional())
+                    name.append("Opt");
+
+                return name;
+            };
+
+            // value types, where index 0 is reserved for tokens
+            auto value_types = vector<string>{};
+            auto value_index = [&](const TypeSpec& type) {
+                auto name = value_type_name(type);
+                auto iter = find(value_types.begin(), value_types.end(), name);
+
+                return static_cast<int>(distance(value_types.begin(), iter)) + 1;
+            };
+
+            for (const auto& var : info->Variables())
+            {
+                auto name = value_type_name(var.Type());
+                if (find(value_types.begin(), value_types.end(), name) == value_types.end())
+                {
+                    value_types.push_back(name);
+                }
+            }
+
+            auto variant_args = "BasicAstToken"s;
+            for (const auto& name : value_types)
+            {
+                variant_args.append(text::Format(", typename Actions::{}", name));
+            }
+
+            const auto root_index = value_index(info->RootVariable().Type());
+            const auto root_type  = text::Format("typename Actions::{}", value_type_name(info->RootVariable().Type()));
+
+            e.EmptyLine();
+            e.Comment("Folds values with Actions as parsing goes instead of constructing AST, where Actions provides");
+            e.Comment("- a value type named after each variable type, e.g. `using Expression = int;`");
+            e.Comment("- methods bound in rules with `@`, which take values of right-hand side in order,");
+            e.Comment("  where a token is passed as its text in data, i.e. std::string_view");
+            e.Comment("NOTE a production without action forwards its selected item or yields its enum hint,");
+            e.Comment("     and a production that does neither must bind an action, see BootstrapParser");
+            e.WriteLine("template <typename Actions>");
+            e.Class("SemanticActionHandler final", "", [&]() {
+                e.WriteLine("public:");
+                e.WriteLine("using ValueType  = std::variant<{}>;", variant_args);
+                e.WriteLine("using ResultType = {};", root_type);
+
+                e.EmptyLine();
+                e.WriteLine("SemanticActionHandler(Actions& actions, std::string_view data) : actions_(actions), data_(data) {{}}");
+
+                e.EmptyLine();
+                e.Block("void OnShift(const BasicAstToken& tok)", [&]() {
+                    e.WriteLine("stack_.emplace_back(std::in_place_index<0>, tok);");
+                });
+                e.Block("void OnReduce(const ProductionInfo& production, ast::AstLocationInfo span, ArrayRef<ast::AstLocationInfo> children)", [&]() {
+                    e.WriteLine("const auto base = stack_.size() - children.Length();");
+                    e.Block("switch (production.Id())", [&]() {
+                        for (const auto& production : info->Productions())
+                        {
+                            // arguments of the action call, where tokens are passed as text
+                            auto take_item = [&](int index) {
+                                const auto symbol = production.Right()[index];
+                                const auto var    = dynamic_cast<const VariableInfo*>(symbol);
+
+                                return text::Format("Take<{}>(base + {})", var ? value_index(var->Type()) : 0, index);
+                            };
+                            auto take_argument = [&](int index) {
+                                return production.Right()[index]->IsVariable()
+                                           ? take_item(index)
+                                           : text::Format("TakeText(base + {})", index);
+                            };
+
+                            auto folded = ""s;
+                            if (!production.Action().empty())
+                            {
+                                auto args = ""s;
+                                for (int i = 0; i < production.Right().size(); ++i)
+                                {
+                                    if (!args.empty())
+                                        args.append(", ");
+
+                                    args.append(take_argument(i));
+                                }
+
+                                folded = text::Format(", actions_.{}({})", production.Action(), args);
+                            }
+                            else if (auto selector = get_if<AstItemSelector>(&production.Handle()->Generator()); selector)
+                            {
+                                folded = ", " + take_item(selector->Index());
+                            }
+                            else if (auto enum_gen = get_if<AstEnumGen>(&production.Handle()->Generator()); enum_gen)
+                            {
+                                const auto enum_type = dynamic_cast<const EnumTypeInfo*>(production.Left()->Type().type);
+                                assert(enum_type != nullptr);
+
+                                folded = text::Format(", {}::{}", enum_type->Name(), enum_type->Values()[enum_gen->Value()]);
+                            }
+                            else
+                            {
+                                throw ParserConstructionError{
+                                    text::Format("BootstrapParser: production of {} constructs a node but binds no action", production.Left()->Name())};
+                            }
+
+                            e.WriteLine("case {}: // {}", production.Id(), production.Left()->Name());
+                            e.WriteLine("    Fold<{}>(base{});", value_index(production.Left()->Type()), folded);
+                            e.WriteLine("    break;");
+                        }
+
+                        e.WriteLine("default:");
+                        e.WriteLine("    throw ParserInternalError{{\"SemanticActionHandler: invalid production\"}};");
+                    });
+                });
+                e.WriteLine("void OnAccept() {{}}");
+                e.WriteLine("void OnError(int offset) {{}}");
+
+                e.EmptyLine();
+                e.Block("ResultType Finalize()", [&]() {
+                    e.WriteLine("assert(stack_.size() == 1);");
+                    e.WriteLine("return Take<{}>(0);", root_index);
+                });
+
+                e.EmptyLine();
+                e.WriteLine("private:");
+                e.WriteLine("template <size_t I>");
+                e.Block("decltype(auto) Take(size_t index)", [&]() {
+                    e.WriteLine("return std::move(std::get<I>(stack_[index]));");
+                });
+                e.Block("std::string_view TakeText(size_t index)", [&]() {
+                    e.WriteLine("const auto& tok = std::get<0>(stack_[index]);");
+                    e.WriteLine("return data_.substr(tok.Offset(), tok.Length());");
+                });
+
+                e.EmptyLine();
+                e.Comment("NOTE value is constructed before its children are popped");
+                e.WriteLine("template <size_t I, typename... Args>");
+                e.Block("void Fold(size_t base, Args&&... args)", [&]() {
+                    e.WriteLine("auto value = std::variant_alternative_t<I, ValueType>(std::forward<Args>(args)...);");
+                    e.WriteLine("stack_.erase(stack_.begin() + base, stack_.end());");
+                    e.WriteLine("stack_.emplace_back(std::in_place_index<I>, std::move(value));");
+                });
+
+                e.EmptyLine();
+                e.WriteLine("Actions& actions_;");
+                e.WriteLine("std::string_view data_;");
+                e.WriteLine("std::vector<ValueType> stack_ = {{}};");
+            });
+
+            e.EmptyLine();
+            e.Comment("parse data and fold it with actions, returns value of the root variable");
+            e.WriteLine("template <typename Actions>");
+            e.Block(text::Format("inline {} Evaluate(BasicParser<{}>& parser, std::string_view data, Actions& actions)", root_type, rootName), [&]() {
+                e.WriteLine("SemanticActionHandler<Actions> handler{{actions, data}};");
+                e.WriteLine("if (!parser.ParseEvents(data, handler).accepted)");
+                e.WriteLine("    throw ParserInternalError{{\"parsing error\"}};");
+
+                e.EmptyLine();
+                e.WriteLine("return handler.Finalize();");
             });
         });
 
@@ -241,8 +480,8 @@ namespace eds::loli
     class ParsingContext
     {
     public:
-        ParsingContext(Arena& arena)
-            : arena_(arena) {}
+        ParsingContext(Arena& arena, ast::AstNodeInterner* interner = nullptr)
+            : arena_(arena), interner_(interner) {}
 
         int StackDepth() const
         {
@@ -267,7 +506,9 @@ namespace eds::loli
 
             // update ast stack
             auto ref    = ArrayRef<ast::AstItemWrapper>(ast_stack_.data(), ast_stack_.size()).TakeBack(count);
-            auto result = production.Handle()->Invoke(arena_, ref);
+            auto result = interner_
+                              ? production.Handle()->InvokeInterned(*interner_, arena_, ref)
+                              : production.Handle()->Invoke(arena_, ref);
 
             for (auto i = 0; i < count; ++i)
                 ast_stack_.pop_back();
@@ -275,233 +516,1411 @@ namespace eds::loli
             return result;
         }
 
+        // for error recovery
+        int StateAt(int index) const
+        {
+            return state_stack_[index];
+        }
+        void ExecutePop()
+        {
+            state_stack_.pop_back();
+            ast_stack_.pop_back();
+        }
+        void ExecuteRecover(int target_state, const VariableInfo& variable, const ast::AstTypeProxyManager& env)
+        {
+            // an error node is an empty list or optional if the variable is one, so that it could still be
+            // selected and merged into, otherwise an empty item, see CompiledGrammar::RecoveryVariables
+            const auto& type = variable.Type();
+
+            auto value = ast::AstItemWrapper{};
+            if (!type.IsNoneQualified() && !type.type->IsToken())
+            {
+                const auto& proxy = *env.Lookup(type.type->Name());
+                value             = type.IsVector() ? proxy.ConstructVector(arena_) : proxy.ConstructOptional();
+            }
+
+            ExecuteShift(target_state, value);
+        }
+
         ast::AstItemWrapper Finalize()
         {
             assert(StackDepth() == 1);
             auto result = ast_stack_.back();
+            Reset();
+
+            return result;
+        }
+
+        // drop whatever is left by a rejected input, so that the context could be reused
+        void Reset()
+        {
             state_stack_.clear();
             ast_stack_.clear();
+        }
 
-            return result;
+        ast::AstItemWrapper TopValue() const
+        {
+            assert(StackDepth() > 0);
+            return ast_stack_.back();
         }
 
     private:
         Arena& arena_;
+        ast::AstNodeInterner* interner_;
 
         std::vector<int> state_stack_               = {};
         std::vector<ast::AstItemWrapper> ast_stack_ = {};
     };
 
+#ifdef LOLITA_PARSE_STATISTICS
     // =====================================================================================
-    // Implementation of GenericParser
+    // Implementation of StatisticsContext
     //
-    GenericParser::GenericParser(const string& config, const ast::AstTypeProxyManager* env)
-    {
-        Initialize(config, env);
-    }
 
-    ParsingAction TranslateAction(parsing::PdaEdge action)
+    // a parsing context that constructs nodes as ParsingContext does while counting into ParseStatistics
+    class StatisticsContext
     {
-        struct Visitor
+    public:
+        StatisticsContext(Arena& arena, ParseStatistics& stats, int production_count)
+            : ctx_(arena), stats_(stats)
         {
-            ParsingAction operator()(parsing::PdaEdgeReduce edge)
-            {
-                return ActionReduce{edge.production};
-            }
-            ParsingAction operator()(parsing::PdaEdgeShift edge)
-            {
-                return ActionShift{edge.target->Id()};
-            }
-        };
+            stats_.productions.resize(max<size_t>(stats_.productions.size(), production_count));
+        }
 
-        return visit(Visitor{}, action);
-    }
+        int StackDepth() const
+        {
+            return ctx_.StackDepth();
+        }
+        int CurrentState() const
+        {
+            return ctx_.CurrentState();
+        }
 
-    void GenericParser::Initialize(const string& config, const ast::AstTypeProxyManager* env)
-    {
-        assert(!config.empty() && env != nullptr);
+        // a token is loaded at offset, where characters before scan_end are stepped by the lexer
+        void RecordToken(const ast::BasicAstToken& tok, int offset, int scan_end, bool ignored)
+        {
+            stats_.lexed_bytes += scan_end - offset;
+            stats_.rescanned_bytes += tok.IsValid() ? scan_end - tok.Offset() - tok.Length() : 0;
+            stats_.ignored_token_count += ignored ? 1 : 0;
+        }
 
-        // resolve basic grammar information
-        //
-        info_ = ResolveParsingInfo(config, env);
+        void ExecuteShift(int target_state, const ast::BasicAstToken& tok)
+        {
+            stats_.shift_count += 1;
+            ExecuteShift(target_state, ast::AstItemWrapper{tok});
+        }
+        void ExecuteShift(int target_state, const ast::AstItemWrapper& value)
+        {
+            ctx_.ExecuteShift(target_state, value);
+            stats_.max_stack_depth = max(stats_.max_stack_depth, ctx_.StackDepth());
+        }
+        ast::AstItemWrapper ExecuteReduce(const ProductionInfo& production)
+        {
+            auto start  = chrono::steady_clock::now();
+            auto result = ctx_.ExecuteReduce(production);
+            auto stop   = chrono::steady_clock::now();
 
-        // computes automata
-        //
-        auto dfa = lexing::BuildLexingAutomaton(*info_);
-        auto pda = parsing::BuildLALRAutomaton(*info_);
+            auto& counter = stats_.productions[production.Id()];
+            counter.reduction_count += 1;
+            counter.reduction_nanoseconds += chrono::duration_cast<chrono::nanoseconds>(stop - start).count();
 
-        // initialize stores
-        //
+            // NOTE ctx_ doesn't hash-cons, so every object or vector generated by the handle is constructed
+            stats_.constructed_node_bytes += production.Handle()->ConstructedSize();
 
-        // basic grammar information
-        token_num_   = info_->Tokens().Size() + info_->IgnoredTokens().Size();
-        term_num_    = info_->Tokens().Size();
-        nonterm_num_ = info_->Variables().Size();
+            return result;
+        }
 
-        dfa_state_num_ = dfa->StateCount();
-        pda_state_num_ = pda->States().size();
+        ast::AstItemWrapper Finalize()
+        {
+            return ctx_.Finalize();
+        }
 
-        // lexing table
-        acc_token_lookup_.Initialize(dfa->StateCount(), nullptr);
-        lexing_table_.Initialize(128 * dfa_state_num_, -1);
+    private:
+        ParsingContext ctx_;
+        ParseStatistics& stats_;
+    };
+#endif
 
-        // parsing table
-        eof_action_table_.Initialize(pda_state_num_, ActionError{});
-        action_table_.Initialize(pda_state_num_ * term_num_, ActionError{});
-        goto_table_.Initialize(pda_state_num_ * nonterm_num_, -1);
+    // =====================================================================================
+    // Implementation of ReductionLogContext
+    //
 
-        // copy lexing automaton
-        //
-        for (int id = 0; id < dfa_state_num_; ++id)
-        {
-            const auto state = dfa->LookupState(id);
+    // a parsing context that records into a ReductionLog instead of constructing nodes
+    class ReductionLogContext
+    {
+    public:
+        ReductionLogContext(ReductionLog& log)
+            : log_(log) {}
 
-            acc_token_lookup_[id] = state->acc_token;
-            for (const auto edge : state->transitions)
-            {
-                lexing_table_[id * 128 + edge.first] = edge.second->id;
-            }
+        int StackDepth() const
+        {
+            return state_stack_.size();
         }
-
-        // copy parsing automaton
-        //
-        for (int src_state_id = 0; src_state_id < pda_state_num_; ++src_state_id)
+        int CurrentState() const
         {
-            auto state = pda->LookupState(src_state_id);
-
-            if (state->EofAction())
-            {
-                eof_action_table_[src_state_id] = TranslateAction(*state->EofAction());
-            }
+            return state_stack_.empty() ? 0 : state_stack_.back();
+        }
 
-            for (const auto& pair : state->ActionMap())
-            {
-                const auto tok_id = pair.first->Id();
+        void ExecuteShift(int target_state, const ast::BasicAstToken& tok)
+        {
+            ExecuteShift(target_state, log_.RecordShift(tok));
+        }
+        void ExecuteShift(int target_state, int entry)
+        {
+            state_stack_.push_back(target_state);
+            entry_stack_.push_back(entry);
+        }
+        int ExecuteReduce(const ProductionInfo& production)
+        {
+            // update state stack
+            const auto count = production.Right().size();
+            for (auto i = 0; i < count; ++i)
+                state_stack_.pop_back();
 
-                action_table_[src_state_id * term_num_ + tok_id] = TranslateAction(pair.second);
-            }
+            // update entry stack
+            auto ref    = ArrayRef<int>(entry_stack_.data(), entry_stack_.size()).TakeBack(count);
+            auto result = log_.RecordReduce(production, ref);
 
-            for (const auto& pair : state->GotoMap())
-            {
-                const auto var_id = pair.first->Id();
+            for (auto i = 0; i < count; ++i)
+                entry_stack_.pop_back();
 
-                goto_table_[src_state_id * nonterm_num_ + var_id] = pair.second->Id();
-            }
+            return result;
         }
-    }
-
-    AstItemWrapper GenericParser::Parse(Arena& arena, const string& data)
-    {
-        ParsingContext ctx{arena};
-        int offset = 0;
 
-        // tokenize and feed parser while not exhausted
-        while (offset < data.length())
+        void Finalize()
         {
-            auto tok = LoadToken(data, offset);
-
-            // update offset
-            offset = tok.Offset() + tok.Length();
-
-            // throw for invalid token
-            if (!tok.IsValid())
-                throw ParserInternalError{"GenericParser: invalid token encountered"};
-            // ignore tokens in blacklist
-            if (tok.Tag() >= term_num_)
-                continue;
-
-            FeedParsingContext(ctx, tok);
+            assert(StackDepth() == 1);
+            state_stack_.clear();
+            entry_stack_.clear();
         }
 
-        // finalize parsing
-        FeedParsingContext(ctx, {});
+    private:
+        ReductionLog& log_;
 
-        return ctx.Finalize();
-    }
+        std::vector<int> state_stack_ = {};
+        std::vector<int> entry_stack_ = {};
+    };
 
-    ast::BasicAstToken GenericParser::LoadToken(std::string_view data, int offset)
-    {
-        auto last_acc_len               = 0;
-        const TokenInfo* last_acc_token = nullptr;
+    // =====================================================================================
+    // Implementation of RecognizerContext
+    //
 
-        auto state = LexerInitialState();
-        for (int i = offset; i < data.length(); ++i)
+    // a parsing context that tracks states only
+    class RecognizerContext
+    {
+    public:
+        // placeholder of a folded variable
+        struct Folded
         {
-            state = LookupLexingTransition(state, data[i]);
+        };
 
-            if (!VerifyLexingState(state))
-            {
-                break;
-            }
-            else if (auto acc_token = LookupAcceptedToken(state); acc_token)
-            {
-                last_acc_len   = i - offset + 1;
-                last_acc_token = acc_token;
-            }
+        int StackDepth() const
+        {
+            return state_stack_.size();
+        }
+        int CurrentState() const
+        {
+            return state_stack_.empty() ? 0 : state_stack_.back();
         }
 
-        if (last_acc_len != 0)
+        void ExecuteShift(int target_state, const ast::BasicAstToken& tok)
         {
-            return ast::BasicAstToken{offset, last_acc_len, last_acc_token->Id()};
+            state_stack_.push_back(target_state);
         }
-        else
+        void ExecuteShift(int target_state, Folded)
         {
-            return ast::BasicAstToken{};
+            state_stack_.push_back(target_state);
         }
-    }
+        Folded ExecuteReduce(const ProductionInfo& production)
+        {
+            const auto count = production.Right().size();
+            state_stack_.resize(state_stack_.size() - count);
 
-    ActionExecutionResult GenericParser::ForwardParsingAction(ParsingContext& ctx, ActionShift action, const ast::BasicAstToken& tok)
-    {
-        assert(tok.IsValid());
+            return Folded{};
+        }
 
-        ctx.ExecuteShift(action.target_state, tok);
-        return ActionExecutionResult::Consumed;
-    }
-    ActionExecutionResult GenericParser::ForwardParsingAction(ParsingContext& ctx, ActionReduce action, const ast::BasicAstToken& tok)
-    {
-        auto folded = ctx.ExecuteReduce(*action.production);
+    private:
+        std::vector<int> state_stack_ = {};
+    };
 
-        auto nonterm_id   = action.production->Left()->Id();
-        auto src_state    = ctx.CurrentState();
-        auto target_state = LookupParsingGoto(src_state, nonterm_id);
+    // =====================================================================================
+    // Implementation of SplitProbeContext
+    //
 
-        ctx.ExecuteShift(target_state, folded);
+    // a recognizing context that also tracks the variable in each slot of the stack, nullptr for a token
+    class SplitProbeContext
+    {
+    public:
+        struct Folded
+        {
+            const VariableInfo* variable;
+        };
 
-        if (!tok.IsValid() &&
-            ctx.StackDepth() == 1 &&
-            action.production->Left() == &info_->RootVariable())
+        int StackDepth() const
         {
-            return ActionExecutionResult::Consumed;
+            return state_stack_.size();
         }
-        else
+        int CurrentState() const
         {
-            return ActionExecutionResult::Hungry;
+            return state_stack_.empty() ? 0 : state_stack_.back();
+        }
+        const VariableInfo* TopVariable() const
+        {
+            return variable_stack_.empty() ? nullptr : variable_stack_.back();
+        }
+
+        void ExecuteShift(int target_state, const ast::BasicAstToken& tok)
+        {
+            state_stack_.push_back(target_state);
+            variable_stack_.push_back(nullptr);
+        }
+        void ExecuteShift(int target_state, Folded folded)
+        {
+            state_stack_.push_back(target_state);
+            variable_stack_.push_back(folded.variable);
+        }
+        Folded ExecuteReduce(const ProductionInfo& production)
+        {
+            const auto count = production.Right().size();
+            state_stack_.resize(state_stack_.size() - count);
+            variable_stack_.resize(variable_stack_.size() - count);
+
+            return Folded{production.Left()};
+        }
+
+    private:
+        std::vector<int> state_stack_                    = {};
+        std::vector<const VariableInfo*> variable_stack_ = {};
+    };
+
+    // =====================================================================================
+    // Implementation of IncrementalContext
+    //
+
+    // a parsing context that records nodes of an IncrementalDocument,
+    // where nodes of earlier revisions could be shifted as they are but never modified
+    class IncrementalContext
+    {
+    public:
+        using Node = IncrementalDocument::Node;
+
+        // thrown when a reused subtree is about to be modified by its new parent, see ExecuteReduce
+        struct ReuseConflict
+        {
+        };
+
+        IncrementalContext(IncrementalDocument& doc)
+            : doc_(doc), revision_begin_(doc.nodes_.size()) {}
+
+        // index of the token to be shifted next
+        void SetCursor(int token_index)
+        {
+            cursor_ = token_index;
+        }
+
+        int StackDepth() const
+        {
+            return state_stack_.size();
+        }
+        int CurrentState() const
+        {
+            return state_stack_.empty() ? 0 : state_stack_.back();
+        }
+
+        void ExecuteShift(int target_state, const ast::BasicAstToken& tok)
+        {
+            const auto anchored = ast::BasicAstToken{doc_.anchors_.ToAnchor(tok.Offset()), tok.Length(), tok.Tag()};
+            ExecuteShift(target_state, AppendNode(Node{nullptr, CurrentState(), 1, 1, -1, false, 0, anchored}));
+        }
+        void ExecuteShift(int target_state, int node)
+        {
+            state_stack_.push_back(target_state);
+            node_stack_.push_back(node);
+        }
+        int ExecuteReduce(const ProductionInfo& production)
+        {
+            auto& nodes        = doc_.nodes_;
+            const auto& handle = *production.Handle();
+
+            // update state stack
+            const auto count = production.Right().size();
+            state_stack_.resize(state_stack_.size() - count);
+
+            // a selected value is modified with its location at least, so it must belong to this revision,
+            // where a list of an earlier revision is copied instead, e.g. an unchanged prefix of a long list
+            if (auto selector = get_if<AstItemSelector>(&handle.Generator()); selector)
+            {
+                auto& selected = node_stack_[node_stack_.size() - count + selector->Index()];
+                if (selected < revision_begin_)
+                {
+                    if (!IsList(nodes[selected]))
+                        throw ReuseConflict{};
+
+                    selected = CopyList(selected);
+                }
+
+                nodes[selected].selected = true;
+            }
+
+            auto children = ArrayRef<int>(node_stack_.data(), node_stack_.size()).TakeBack(count);
+
+            // construct value
+            auto node = Node{&production, CurrentState(), 0, 1, static_cast<int>(doc_.child_pool_.size()), false, 0, {}};
+
+            values_.clear();
+            for (auto child : children)
+            {
+                values_.push_back(nodes[child].value);
+                doc_.child_pool_.push_back(child);
+
+                node.token_count += nodes[child].token_count;
+                node.node_count += nodes[child].node_count;
+            }
+
+            node.value = handle.Invoke(*doc_.arena_, ArrayRef<ast::AstItemWrapper>(values_.data(), values_.size()));
+            if (IsList(node) && node.value.HasValue())
+            {
+                node.element_count = handle.Proxy().ElementCount(node.value);
+            }
+
+            // the value is either new or selected from this revision, whose location is reset as
+            // one computed from locations of children is meaningless if their anchors don't run on
+            if (node.token_count > 0 && node.value.HasValue())
+            {
+                const auto first = doc_.tokens_.At(cursor_ - node.token_count);
+                const auto last  = doc_.tokens_.At(cursor_ - 1);
+
+                node.value.UpdateLocationInfo(doc_.anchors_.ToAnchor(first.Offset()), last.Offset() + last.Length() - first.Offset());
+            }
+
+            node_stack_.resize(node_stack_.size() - count);
+            return AppendNode(node);
+        }
+
+        // index of the root node
+        int Finalize()
+        {
+            assert(StackDepth() == 1);
+            return node_stack_.back();
+        }
+
+    private:
+        static bool IsList(const Node& node)
+        {
+            return node.production != nullptr && node.production->Left()->Type().IsVector();
+        }
+
+        // a node of this revision same as a list node of an earlier revision, except that its value is a copy
+        // of only elements in the subtree, as the original list is merged into in place by its parents
+        int CopyList(int list_node)
+        {
+            auto node         = doc_.nodes_[list_node];
+            const auto& proxy = node.production->Handle()->Proxy();
+
+            auto value = proxy.ConstructVector(*doc_.arena_);
+            proxy.ReserveElements(value, node.element_count);
+            for (int i = 0; i < node.element_count; ++i)
+            {
+                proxy.PushBackElement(value, proxy.ExtractElement(node.value, i));
+            }
+
+            node.selected = false;
+            node.value    = value;
+            return AppendNode(node);
+        }
+
+        int AppendNode(const Node& node)
+        {
+            doc_.nodes_.push_back(node);
+            doc_.arena_node_count_ += 1;
+
+            return static_cast<int>(doc_.nodes_.size()) - 1;
+        }
+
+        IncrementalDocument& doc_;
+
+        // nodes before it belong to earlier revisions
+        int revision_begin_;
+
+        int cursor_ = 0;
+
+        std::vector<int> state_stack_            = {};
+        std::vector<int> node_stack_             = {};
+        std::vector<ast::AstItemWrapper> values_ = {};
+    };
+
+    // =====================================================================================
+    // Implementation of TokenMapping
+    //
+
+    // correspondence of unchanged tokens before and after an edit, where
+    // leading tokens are identical and trailing tokens are identical except their offsets
+    struct TokenMapping
+    {
+        int old_count;
+        int new_count;
+
+        int prefix;
+        int suffix;
+
+        // offset difference of trailing tokens
+        int offset_delta;
+
+        bool InPrefix(int old_index) const
+        {
+            return old_index < prefix;
+        }
+        bool InSuffix(int old_index) const
+        {
+            return old_index >= old_count - suffix;
+        }
+
+        // maps a token index of old tokens to new ones, -1 if changed
+        // NOTE eof is mapped to eof
+        int ToNew(int old_index) const
+        {
+            if (InPrefix(old_index))
+                return old_index;
+            else if (InSuffix(old_index))
+                return old_index + new_count - old_count;
+            else
+                return -1;
+        }
+        int ToOld(int new_index) const
+        {
+            if (new_index < prefix)
+                return new_index;
+            else if (new_index >= new_count - suffix)
+                return new_index + old_count - new_count;
+            else
+                return -1;
+        }
+    };
+
+    // =====================================================================================
+    // Implementation of ReusableNodeCursor
+    //
+
+    // walks down the tree of an IncrementalDocument to nodes starting at a given token,
+    // where tokens are visited in ascending order so that each node is entered at most once
+    class ReusableNodeCursor
+    {
+    public:
+        using Node = IncrementalDocument::Node;
+
+        ReusableNodeCursor(const IncrementalDocument& doc)
+            : doc_(doc)
+        {
+            if (doc.root_node_ != -1)
+            {
+                path_.push_back(Frame{doc.root_node_, 0, 0, 0});
+            }
+        }
+
+        // nodes starting at token from the outermost one, the last of which is a token
+        // NOTE token must not be less than that of the previous call
+        const std::vector<int>& Seek(int token)
+        {
+            candidates_.clear();
+
+            // leave nodes before token
+            while (!path_.empty() && path_.back().first_token + TokenCount(path_.back().node) <= token)
+            {
+                path_.pop_back();
+            }
+
+            if (path_.empty())
+            {
+                return candidates_;
+            }
+
+            // enter the child containing token until reaching a token
+            while (doc_.nodes_[path_.back().node].production)
+            {
+                auto& frame      = path_.back();
+                const auto& node = doc_.nodes_[frame.node];
+                const auto& pool = doc_.child_pool_;
+                const auto count = static_cast<int>(node.production->Right().size());
+
+                while (frame.child < count && frame.child_first_token + TokenCount(pool[node.first_child + frame.child]) <= token)
+                {
+                    frame.child_first_token += TokenCount(pool[node.first_child + frame.child]);
+                    frame.child += 1;
+                }
+
+                assert(frame.child < count);
+                path_.push_back(Frame{pool[node.first_child + frame.child], frame.child_first_token, 0, frame.child_first_token});
+            }
+
+            // nodes starting at token are at the bottom of the path
+            for (auto it = path_.rbegin(); it != path_.rend() && it->first_token == token; ++it)
+            {
+                candidates_.push_back(it->node);
+            }
+
+            reverse(candidates_.begin(), candidates_.end());
+            return candidates_;
+        }
+
+    private:
+        struct Frame
+        {
+            int node;
+            int first_token;
+
+            // the child being entered or to be examined next, and its first token
+            int child;
+            int child_first_token;
+        };
+
+        int TokenCount(int node) const
+        {
+            return doc_.nodes_[node].token_count;
+        }
+
+        const IncrementalDocument& doc_;
+
+        std::vector<Frame> path_     = {};
+        std::vector<int> candidates_ = {};
+    };
+
+    // =====================================================================================
+    // Implementation of GenericParser
+    //
+    GenericParser::GenericParser(const string& config, const ast::AstTypeProxyManager* env, size_t table_budget)
+    {
+        Initialize(config, env, table_budget);
+    }
+
+    GenericParser::GenericParser(shared_ptr<const CompiledGrammar> grammar)
+        : grammar_(move(grammar))
+    {
+        assert(grammar_ != nullptr);
+    }
+
+    void GenericParser::Initialize(const string& config, const ast::AstTypeProxyManager* env, size_t table_budget)
+    {
+        grammar_ = CompileGrammar(config, env, table_budget);
+    }
+
+    AstItemWrapper GenericParser::Parse(Arena& arena, const string& data) const
+    {
+        auto result = TryParse(arena, data);
+        if (!result)
+        {
+            ThrowParsingError(result.status);
+        }
+
+        return result.value;
+    }
+
+    ParsingResult<AstItemWrapper> GenericParser::TryParse(Arena& arena, const string& data) const
+    {
+        TraceSpan span{"Parse", "parsing"};
+        span.Count("bytes", data.length());
+
+        ParsingContext ctx{arena};
+        if (auto status = ProcessInput(ctx, data); !status.accepted)
+        {
+            return ParsingResult<AstItemWrapper>{AstItemWrapper{}, status};
+        }
+
+        return ParsingResult<AstItemWrapper>{ctx.Finalize(), ValidationResult{true, -1}};
+    }
+
+#ifdef LOLITA_PARSE_STATISTICS
+    ParsingResult<AstItemWrapper> GenericParser::TryParseWithStatistics(Arena& arena, const string& data, ParseStatistics& stats) const
+    {
+        StatisticsContext ctx{arena, stats, static_cast<int>(grammar_->Info().Productions().Size())};
+        if (auto status = ProcessInput(ctx, data); !status.accepted)
+        {
+            return ParsingResult<AstItemWrapper>{AstItemWrapper{}, status};
+        }
+
+        return ParsingResult<AstItemWrapper>{ctx.Finalize(), ValidationResult{true, -1}};
+    }
+#endif
+
+    AstItemWrapper GenericParser::ParseAs(Arena& arena, const string& data, const string& entry) const
+    {
+        auto result = TryParseAs(arena, data, entry);
+        if (!result)
+        {
+            ThrowParsingError(result.status);
+        }
+
+        return result.value;
+    }
+
+    ParsingResult<AstItemWrapper> GenericParser::TryParseAs(Arena& arena, const string& data, const string& entry) const
+    {
+        if (entry == grammar_->Info().RootVariable().Name())
+        {
+            return TryParse(arena, data);
+        }
+
+        auto entry_info = grammar_->Info().LookupEntry(entry);
+        if (entry_info == nullptr)
+        {
+            throw ParserInternalError{"GenericParser: not a start symbol of the grammar"};
+        }
+
+        // shift the marker of entry, which carries no value, see ParsingMetaInfo::EntryInfo
+        const auto entry_index = distance(grammar_->Info().Entries().data(), entry_info);
+
+        ParsingContext ctx{arena};
+        ctx.ExecuteShift(grammar_->LookupEntryState(entry_index), AstItemWrapper{});
+
+        if (auto status = ProcessInput(ctx, data); !status.accepted)
+        {
+            return ParsingResult<AstItemWrapper>{AstItemWrapper{}, status};
+        }
+
+        return ParsingResult<AstItemWrapper>{ctx.Finalize(), ValidationResult{true, -1}};
+    }
+
+    AstItemWrapper GenericParser::ParseInterned(Arena& arena, const string& data, AstNodeInterner::Statistics* stats) const
+    {
+        // a shared object must not be modified after construction
+        for (const auto& production : grammar_->Info().Productions())
+        {
+            if (production.Handle()->MutatesSelection())
+                throw ParserInternalError{"GenericParser: grammar modifies selected objects, hash-consing not supported"};
+        }
+
+        AstNodeInterner interner{data};
+
+        ParsingContext ctx{arena, &interner};
+        if (auto result = ProcessInput(ctx, data); !result.accepted)
+        {
+            ThrowParsingError(result);
+        }
+
+        if (stats)
+        {
+            *stats = interner.Stats();
+        }
+
+        return ctx.Finalize();
+    }
+
+    unique_ptr<ReductionLog> GenericParser::ParseLazy(const string& data) const
+    {
+        auto log = make_unique<ReductionLog>();
+
+        ReductionLogContext ctx{*log};
+        if (auto result = ProcessInput(ctx, data); !result.accepted)
+        {
+            ThrowParsingError(result);
+        }
+
+        ctx.Finalize();
+
+        return log;
+    }
+
+    ValidationResult GenericParser::Validate(string_view data) const
+    {
+        RecognizerContext ctx;
+        return ProcessInput(ctx, data);
+    }
+
+    ParallelParsingResult<AstItemWrapper> GenericParser::ParseParallel(Arena& arena, const string& data, int thread_count) const
+    {
+        auto result = ParallelParsingResult<AstItemWrapper>{AstItemWrapper{}, ValidationResult{false, -1}};
+
+        TraceSpan span{"ParseParallel", "parsing"};
+        span.Count("bytes", data.length());
+
+        if (thread_count <= 0)
+            thread_count = max(1, static_cast<int>(thread::hardware_concurrency()));
+
+        // tokenize ahead to find candidates of chunk boundaries
+        auto tokens = vector<BasicAstToken>{};
+        {
+            TraceSpan tokenizing_span{"Tokenize", "parsing"};
+
+            for (int offset = 0; offset < data.length();)
+            {
+                auto tok = LoadToken(data, offset);
+                if (!tok.IsValid())
+                {
+                    result.status = ValidationResult{false, offset, ParsingErrorKind::InvalidToken};
+                    return result;
+                }
+
+                offset = tok.Offset() + tok.Length();
+
+                // ignore tokens in blacklist
+                if (tok.Tag() < grammar_->TermCount())
+                    tokens.push_back(tok);
+            }
+
+            tokenizing_span.Count("tokens", tokens.size());
+        }
+
+        const auto count = static_cast<int>(tokens.size());
+
+        // split at split tokens into chunks of roughly even size, a few for each worker
+        const auto chunk_size = max(1, count / (thread_count * 4));
+
+        auto bounds = vector<int>{0};
+        for (int i = 1; i < count; ++i)
+        {
+            if (IsSplitToken(tokens[i].Tag()) && i - bounds.back() >= chunk_size)
+                bounds.push_back(i);
+        }
+
+        bounds.push_back(count);
+
+        const auto chunk_count = static_cast<int>(bounds.size()) - 1;
+        result.chunk_count     = chunk_count;
+
+        // serial parsing
+        //
+
+        ParsingContext ctx{arena};
+
+        auto feed = [&](int begin, int end) {
+            for (int i = begin; i < end; ++i)
+            {
+                if (!FeedParsingContext(ctx, tokens[i]))
+                {
+                    result.status = ValidationResult{false, tokens[i].Offset(), ParsingErrorKind::UnexpectedToken, tokens[i], ctx.CurrentState()};
+                    return false;
+                }
+            }
+
+            return true;
+        };
+        auto lookahead_at = [&](int index) {
+            return index < count ? tokens[index] : BasicAstToken{};
+        };
+
+        auto serial_parse = [&]() {
+            result.chunk_count = 1;
+            if (feed(0, count))
+            {
+                if (FeedParsingContext(ctx, {}))
+                {
+                    result.value  = ctx.Finalize();
+                    result.status = ValidationResult{true, -1};
+                }
+                else
+                {
+                    result.status = ValidationResult{false, static_cast<int>(data.length()), ParsingErrorKind::UnexpectedEof, {}, ctx.CurrentState()};
+                }
+            }
+
+            return move(result);
+        };
+
+        if (thread_count == 1 || chunk_count < 2 || grammar_->Info().Environment() == nullptr)
+        {
+            return serial_parse();
+        }
+
+        // probe the stack at the first split token left with a single list variable,
+        // which is then expected at any boundary
+        // NOTE the first boundary is probed as well, since it may be the first split token at the top level
+        //
+
+        SplitProbeContext probe;
+        for (int i = 0; i <= bounds[1]; ++i)
+        {
+            if (i > 0 && IsSplitToken(tokens[i].Tag()))
+            {
+                for (auto action = LookupParsingAction(probe.CurrentState(), tokens[i].Tag());
+                     holds_alternative<ActionReduce>(action);
+                     action = LookupParsingAction(probe.CurrentState(), tokens[i].Tag()))
+                {
+                    ForwardParsingAction(probe, get<ActionReduce>(action), tokens[i]);
+                }
+
+                const auto variable = probe.TopVariable();
+                if (probe.StackDepth() == 1 && variable != nullptr && variable->Type().IsVector())
+                    break;
+            }
+
+            if (!FeedParsingContext(probe, tokens[i]))
+                return serial_parse();
+        }
+
+        const auto list           = probe.TopVariable();
+        const auto boundary_state = probe.CurrentState();
+        if (probe.StackDepth() != 1 || list == nullptr || !list->Type().IsVector())
+        {
+            return serial_parse();
+        }
+
+        const auto& proxy = *grammar_->Info().Environment()->Lookup(list->Type().type->Name());
+
+        // speculate chunks following the first one in parallel
+        //
+
+        struct ChunkResult
+        {
+            // a partial list covering the chunk
+            AstItemWrapper value = {};
+
+            bool speculated = false;
+        };
+
+        auto chunks = vector<ChunkResult>(chunk_count);
+        for (int i = 0; i < thread_count; ++i)
+        {
+            result.arenas.push_back(make_unique<Arena>());
+        }
+
+        atomic<int> next_chunk = 1;
+        atomic<bool> cancelled = false;
+
+        auto speculate = [&](int id) {
+            TraceSpan worker_span{"SpeculateChunks", "parsing"};
+
+            auto& worker_arena = *result.arenas[id];
+            ParsingContext spec_ctx{worker_arena};
+
+            auto speculated_count = 0;
+            for (int k = next_chunk++; k < chunk_count && !cancelled; k = next_chunk++)
+            {
+                try
+                {
+                    // start with an empty list as if the chunk is the first part of it
+                    spec_ctx.Reset();
+                    spec_ctx.ExecuteShift(boundary_state, proxy.ConstructVector(worker_arena));
+
+                    auto accepted = true;
+                    for (int i = bounds[k]; i < bounds[k + 1] && accepted; ++i)
+                    {
+                        accepted = FeedParsingContext(spec_ctx, tokens[i]);
+                    }
+
+                    if (accepted && ReduceToBoundary(spec_ctx, lookahead_at(bounds[k + 1]), list, boundary_state))
+                    {
+                        chunks[k] = ChunkResult{spec_ctx.Finalize(), true};
+                        speculated_count += 1;
+                    }
+                }
+                catch (...)
+                {
+                    // leave it to the serial parse, which reports the error if it's real
+                }
+            }
+
+            worker_span.Count("speculated_chunks", speculated_count);
+        };
+
+        auto threads = vector<thread>{};
+        auto join_workers = [&]() {
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+        };
+
+        // workers read locals of this function, so they must be joined before an exception leaves it
+        auto at_boundary = false;
+        try
+        {
+            for (int id = 1; id < thread_count; ++id)
+            {
+                threads.emplace_back(speculate, id);
+            }
+
+            // the first chunk starts in the initial state for sure
+            if (!feed(bounds[0], bounds[1]))
+            {
+                cancelled = true;
+                join_workers();
+
+                return result;
+            }
+
+            at_boundary = ReduceToBoundary(ctx, lookahead_at(bounds[1]), list, boundary_state);
+            speculate(0);
+        }
+        catch (...)
+        {
+            cancelled = true;
+            join_workers();
+
+            throw;
+        }
+
+        join_workers();
+
+        // merge chunks in order, where a chunk is speculated correctly if the previous one ends at a boundary
+        //
+
+        TraceSpan merging_span{"MergeChunks", "parsing"};
+        merging_span.Count("chunks", chunk_count);
+
+        for (int k = 1; k < chunk_count; ++k)
+        {
+            if (at_boundary && chunks[k].speculated)
+            {
+                auto whole   = ctx.TopValue();
+                auto partial = chunks[k].value;
+
+                const auto size = proxy.ElementCount(partial);
+                proxy.ReserveElements(whole, proxy.ElementCount(whole) + size);
+                for (int i = 0; i < size; ++i)
+                {
+                    proxy.PushBackElement(whole, proxy.ExtractElement(partial, i));
+                }
+
+                const auto loc      = whole.GetLocationInfo();
+                const auto& last    = tokens[bounds[k + 1] - 1];
+                const auto last_end = last.Offset() + last.Length();
+                whole.UpdateLocationInfo(loc.offset, last_end - loc.offset);
+            }
+            else
+            {
+                result.reparsed_count += 1;
+                if (!feed(bounds[k], bounds[k + 1]))
+                    return result;
+
+                at_boundary = ReduceToBoundary(ctx, lookahead_at(bounds[k + 1]), list, boundary_state);
+            }
+        }
+
+        // finalize parsing, where a list as root is already accepted
+        if ((at_boundary && list == &grammar_->Info().RootVariable()) || FeedParsingContext(ctx, {}))
+        {
+            result.value  = ctx.Finalize();
+            result.status = ValidationResult{true, -1};
+        }
+        else
+        {
+            result.status = ValidationResult{false, static_cast<int>(data.length()), ParsingErrorKind::UnexpectedEof, {}, ctx.CurrentState()};
+        }
+
+        return result;
+    }
+
+    BatchParsingResult<AstItemWrapper> GenericParser::ParseBatch(ArrayRef<const string_view> inputs, int thread_count) const
+    {
+        const auto count = static_cast<int>(inputs.Length());
+
+        TraceSpan span{"ParseBatch", "parsing"};
+        span.Count("documents", count);
+
+        if (thread_count <= 0)
+            thread_count = max(1, static_cast<int>(thread::hardware_concurrency()));
+
+        thread_count = max(1, min(thread_count, count));
+
+        auto result = BatchParsingResult<AstItemWrapper>{};
+        result.results.resize(count, ParsingResult<AstItemWrapper>{AstItemWrapper{}, ValidationResult{false, -1}});
+        for (int i = 0; i < thread_count; ++i)
+        {
+            result.arenas.push_back(make_unique<Arena>());
+        }
+
+        // documents are claimed one by one, so that a worker that finishes early takes over the rest
+        atomic<int> next_index = 0;
+        atomic<bool> failed    = false;
+        vector<exception_ptr> exceptions(thread_count);
+
+        auto worker = [&](int id) {
+            TraceSpan worker_span{"ParseBatchWorker", "parsing"};
+
+            ParsingContext ctx{*result.arenas[id]};
+
+            auto document_count = 0;
+            try
+            {
+                for (int i = next_index++; i < count && !failed; i = next_index++, ++document_count)
+                {
+                    ctx.Reset();
+                    if (auto status = ProcessInput(ctx, inputs.At(i)); !status.accepted)
+                    {
+                        result.results[i] = ParsingResult<AstItemWrapper>{AstItemWrapper{}, status};
+                    }
+                    else
+                    {
+                        result.results[i] = ParsingResult<AstItemWrapper>{ctx.Finalize(), ValidationResult{true, -1}};
+                    }
+                }
+            }
+            catch (...)
+            {
+                // e.g. a handle fails to construct a node
+                exceptions[id] = current_exception();
+                failed         = true;
+            }
+
+            worker_span.Count("documents", document_count);
+        };
+
+        auto threads      = vector<thread>{};
+        auto join_workers = [&]() {
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+        };
+
+        // workers read locals of this function, so they must be joined before an exception leaves it,
+        // e.g. a thread fails to start
+        try
+        {
+            for (int id = 1; id < thread_count; ++id)
+            {
+                threads.emplace_back(worker, id);
+            }
+        }
+        catch (...)
+        {
+            failed = true;
+            join_workers();
+
+            throw;
+        }
+
+        worker(0);
+        join_workers();
+
+        for (const auto& e : exceptions)
+        {
+            if (e)
+                rethrow_exception(e);
+        }
+
+        return result;
+    }
+
+    RecoveredParsingResult<AstItemWrapper> GenericParser::ParseWithRecovery(Arena& arena, const string& data, int max_errors) const
+    {
+        assert(max_errors > 0);
+
+        ParsingContext ctx{arena};
+
+        auto errors    = vector<ValidationResult>{};
+        auto completed = ProcessInputWithRecovery(ctx, data, errors, max_errors);
+        auto value     = completed ? ctx.Finalize() : AstItemWrapper{};
+
+        return RecoveredParsingResult<AstItemWrapper>{value, completed, move(errors)};
+    }
+
+    ValidationResult GenericParser::Tokenize(TokenBuffer& buffer) const
+    {
+        buffer.Reset(true);
+        return RelexTokens(buffer, 0, 0, 0);
+    }
+
+    ValidationResult GenericParser::Retokenize(TokenBuffer& buffer, int offset, int removed_length, string_view inserted) const
+    {
+        assert(offset >= 0 && removed_length >= 0 && offset + removed_length <= buffer.text_.length());
+
+        buffer.text_.replace(offset, removed_length, inserted);
+        if (!buffer.IsValid())
+        {
+            return Tokenize(buffer);
+        }
+
+        // relex from the token preceding the first affected one, which is unchanged,
+        // so that ignored tokens following it are attached properly
+        const auto first = max(0, buffer.FindAffected(offset) - 1);
+        const auto delta = static_cast<int>(inserted.length()) - removed_length;
+
+        return RelexTokens(buffer, first, offset + removed_length, delta);
+    }
+
+    ValidationResult GenericParser::ParseDocument(IncrementalDocument& doc) const
+    {
+        doc.ResetTree();
+        doc.anchors_.Reset(doc.Text().length());
+
+        if (auto status = Tokenize(doc.tokens_); !status.accepted)
+        {
+            return status;
         }
+
+        // nothing to reuse
+        const auto count = doc.tokens_.Size();
+        return ParseDocumentTokens(doc, TokenMapping{0, count, 0, 0, 0});
     }
-    ActionExecutionResult GenericParser::ForwardParsingAction(ParsingContext& ctx, ActionError action, const ast::BasicAstToken& tok)
+
+    ValidationResult GenericParser::Reparse(IncrementalDocument& doc, int offset, int removed_length, string_view inserted) const
     {
-        return ActionExecutionResult::Error;
+        const auto old_count = doc.tokens_.Size();
+        const auto retained  = doc.tokens_.IsValid() && doc.root_node_ != -1;
+
+        doc.anchors_.Replace(offset, removed_length, inserted.length());
+        if (auto status = Retokenize(doc.tokens_, offset, removed_length, inserted); !status.accepted)
+        {
+            doc.ResetTree();
+            return status;
+        }
+
+        // tokens out of the damaged range are unchanged except their offsets,
+        // while a rejected document has nothing to reuse
+        const auto& damage   = doc.tokens_.LastDamage();
+        const auto new_count = doc.tokens_.Size();
+        const auto prefix    = retained ? damage.first_token : 0;
+        const auto suffix    = retained ? old_count - damage.first_token - damage.removed_count : 0;
+
+        return ParseDocumentTokens(doc, TokenMapping{old_count, new_count, prefix, suffix, damage.offset_delta});
     }
 
-    void GenericParser::FeedParsingContext(ParsingContext& ctx, const ast::BasicAstToken& tok)
+    ValidationResult GenericParser::RelexTokens(TokenBuffer& buffer, int first, int damage_end, int delta) const
     {
-        while (true)
+        using Entry = TokenBuffer::Entry;
+
+        const auto data      = string_view{buffer.text_};
+        const auto old_count = buffer.Size();
+        const auto start     = first > 0 ? buffer.At(first).Offset() : 0;
+
+        auto replacement = vector<Entry>{};
+        auto scan_end    = first > 0 ? buffer.ScanEndOf(first - 1) : 0;
+        auto resync      = old_count;
+
+        auto offset = start;
+        for (int candidate = first; offset < data.length();)
         {
-            auto cur_state = ctx.CurrentState();
-            auto action    = tok.IsValid()
-                              ? LookupParsingAction(cur_state, tok.Tag())
-                              : LookupParsingActionOnEof(cur_state);
+            int token_scan_end;
+            auto tok = LoadToken(data, offset, token_scan_end);
+            if (!tok.IsValid())
+            {
+                buffer.Reset(false);
+                return ValidationResult{false, offset, ParsingErrorKind::InvalidToken};
+            }
+
+            offset   = tok.Offset() + tok.Length();
+            scan_end = max(scan_end, token_scan_end);
+
+            // ignored tokens are attached to the preceding one
+            if (tok.Tag() >= grammar_->TermCount())
+            {
+                if (!replacement.empty())
+                    replacement.back().scan_end = scan_end;
+
+                continue;
+            }
+
+            // stop at an old token after the damage, since lexing from there is the same as before
+            while (candidate < old_count && buffer.At(candidate).Offset() + delta < tok.Offset())
+            {
+                candidate += 1;
+            }
+
+            if (candidate < old_count)
+            {
+                const auto old_tok = buffer.At(candidate);
+                if (old_tok.Offset() >= damage_end && old_tok.Offset() + delta == tok.Offset() && old_tok.Tag() == tok.Tag())
+                {
+                    resync = candidate;
+                    break;
+                }
+            }
+
+            replacement.push_back(Entry{tok.Offset(), tok.Length(), tok.Tag(), scan_end});
+        }
+
+        buffer.Splice(first, resync, replacement, delta, scan_end);
+
+        // the token relexed ahead of affected ones is unchanged, see Retokenize
+        const auto unchanged      = first > 0 ? 1 : 0;
+        const auto inserted_count = static_cast<int>(replacement.size()) - unchanged;
+        buffer.damage_            = TokenBuffer::Damage{first + unchanged, resync - first - unchanged, inserted_count, delta, offset - start};
+
+        return ValidationResult{true, -1};
+    }
+
+    ValidationResult GenericParser::ParseDocumentTokens(IncrementalDocument& doc, const TokenMapping& mapping) const
+    {
+        const auto& tokens = doc.tokens_;
+        const auto count   = tokens.Size();
+
+        auto stats = IncrementalDocument::Statistics{};
+
+        auto parse = [&](const TokenMapping& reusable) {
+            stats = IncrementalDocument::Statistics{};
+            stats.relexed_token_count = tokens.LastDamage().inserted_count;
+
+            // subtrees of the previous tree are looked up before nodes of this revision are appended
+            IncrementalContext ctx{doc};
+            ReusableNodeCursor cursor{doc};
+
+            // reuse the largest subtree starting at new token index,
+            // returns index of token following the subtree, or -1 if none is reused
+            auto try_reuse = [&](int index) {
+                const auto old_index = reusable.ToOld(index);
+                if (old_index == -1)
+                    return -1;
+
+                for (auto k : cursor.Seek(old_index))
+                {
+                    const auto& node = doc.nodes_[k];
+
+                    // only non-empty subtrees, as the path ends with a token
+                    if (node.production == nullptr)
+                        break;
+
+                    // same left context
+                    if (node.state != ctx.CurrentState())
+                        continue;
+
+                    // value is not modified by the parent, unless it's a list copied when modified
+                    if (node.selected && !node.production->Left()->Type().IsVector())
+                        continue;
+
+                    // tokens and the lookahead are unchanged
+                    const auto last_token = old_index + node.token_count;
+                    if (reusable.InPrefix(old_index) && last_token > reusable.prefix)
+                        continue;
+
+                    const auto last   = reusable.ToNew(last_token - 1);
+                    const auto follow = reusable.ToNew(last_token);
+                    if (last == -1 || follow != last + 1)
+                        continue;
+
+                    const auto target_state = LookupParsingGoto(ctx.CurrentState(), node.production->Left()->Id());
+                    if (target_state == -1)
+                        continue;
+
+                    // the subtree is shared as is, since nodes only know sizes of their children
+                    // and values are located by anchors
+                    stats.reused_node_count += node.node_count;
+                    ctx.ExecuteShift(target_state, k);
+
+                    return follow;
+                }
+
+                return -1;
+            };
+
+            for (int i = 0; i < count;)
+            {
+                const auto tok = tokens.At(i);
+                ctx.SetCursor(i);
+
+                // reduce on lookahead
+                auto action = LookupParsingAction(ctx.CurrentState(), tok.Tag());
+                while (holds_alternative<ActionReduce>(action))
+                {
+                    ForwardParsingAction(ctx, get<ActionReduce>(action), tok);
+                    action = LookupParsingAction(ctx.CurrentState(), tok.Tag());
+                }
+
+                if (holds_alternative<ActionError>(action))
+                {
+                    return ValidationResult{false, tok.Offset(), ParsingErrorKind::UnexpectedToken, tok, ctx.CurrentState()};
+                }
+
+                // shift either a reused subtree or the token
+                if (auto next = try_reuse(i); next != -1)
+                {
+                    i = next;
+                }
+                else
+                {
+                    ForwardParsingAction(ctx, get<ActionShift>(action), tok);
 
-            auto action_result = visit([&](auto x) { return ForwardParsingAction(ctx, x, tok); }, action);
+                    stats.shifted_token_count += 1;
+                    i += 1;
+                }
+            }
 
-            if (action_result == ActionExecutionResult::Error)
+            // finalize parsing
+            ctx.SetCursor(count);
+            if (!FeedParsingContext(ctx, {}))
             {
-                throw ParserInternalError{"parsing error"};
+                return ValidationResult{false, static_cast<int>(doc.Text().length()), ParsingErrorKind::UnexpectedEof, {}, ctx.CurrentState()};
             }
-            else if (action_result == ActionExecutionResult::Consumed)
+
+            doc.root_node_ = ctx.Finalize();
+            doc.root_      = doc.nodes_[doc.root_node_].value;
+
+            return ValidationResult{true, -1};
+        };
+
+        // a reused subtree may turn out to be selected by its new parent, then nothing is reused
+        auto status = ValidationResult{};
+        try
+        {
+            status = parse(mapping);
+        }
+        catch (const IncrementalContext::ReuseConflict&)
+        {
+            status = parse(TokenMapping{mapping.old_count, mapping.new_count, 0, 0, 0});
+        }
+
+        doc.stats_ = stats;
+        if (!status.accepted)
+        {
+            doc.ResetTree();
+            return status;
+        }
+
+        // drop nodes of earlier revisions once they outnumber the current tree,
+        // and items in the arena once they are mostly dropped, i.e. 3/4 of those created
+        const auto live_count = doc.nodes_[doc.root_node_].node_count;
+        if (doc.arena_node_count_ > 4 * live_count)
+        {
+            doc.CompactNodes();
+            doc.RebuildArena();
+
+            doc.stats_.arena_rebuilt = true;
+        }
+        else if (static_cast<int>(doc.nodes_.size()) > 2 * live_count)
+        {
+            doc.CompactNodes();
+        }
+
+        return status;
+    }
+
+    void GenericParser::ThrowParsingError(const ValidationResult& result) const
+    {
+        assert(!result.accepted);
+
+        if (result.error_kind == ParsingErrorKind::InvalidToken)
+            throw ParserInternalError{"GenericParser: invalid token encountered"};
+        else
+            throw ParserInternalError{"parsing error"};
+    }
+
+    ast::BasicAstToken GenericParser::LoadToken(std::string_view data, int offset) const
+    {
+        int scan_end;
+        return LoadToken(data, offset, scan_end);
+    }
+
+    ast::BasicAstToken GenericParser::LoadToken(std::string_view data, int offset, int& scan_end) const
+    {
+        auto last_acc_len               = 0;
+        const TokenInfo* last_acc_token = nullptr;
+
+        // the lexer examines eof if it's not stopped by a character
+        scan_end = data.length() + 1;
+
+        auto state = LexerInitialState();
+        for (int i = offset; i < data.length(); ++i)
+        {
+            state = LookupLexingTransition(state, data[i]);
+
+            if (!VerifyLexingState(state))
             {
+                scan_end = i + 1;
                 break;
             }
+            else if (auto acc_token = LookupAcceptedToken(state); acc_token)
+            {
+                last_acc_len   = i - offset + 1;
+                last_acc_token = acc_token;
+            }
+        }
+
+        if (last_acc_len != 0)
+        {
+            return ast::BasicAstToken{offset, last_acc_len, last_acc_token->Id()};
+        }
+        else
+        {
+            return ast::BasicAstToken{};
         }
     }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "parsing/grammar.h"
+#include "core/trace.h"
 #include <cassert>
 
 using namespace std;
@@ -99,9 +100,10 @@ namespace eds::loli::parsing
         lhs->productions_.push_back(result);
     }
 
-    unique_ptr<Grammar> GrammarBuilder::Build(Nonterminal* root)
+    unique_ptr<Grammar> GrammarBuilder::Build(Nonterminal* root, const vector<Nonterminal*>& entries)
     {
-        site_->root_symbol_ = root;
+        site_->root_symbol_   = root;
+        site_->entry_symbols_ = entries;
 
         ComputeFirstSet();
         ComputeFollowSet();
@@ -109,8 +111,8 @@ namespace eds::loli::parsing
         return move(site_);
     }
 
-    // try to insert FIRST SET of s into output
-    static bool TryInsertFIRST(TerminalSet& output, Symbol* s)
+    // try to insert FIRST SET of s into output, where insert_count counts terminals inserted or not
+    static bool TryInsertFIRST(TerminalSet& output, Symbol* s, int64_t& insert_count)
     {
         // remember output's size
         const auto old_output_sz = output.size();
@@ -119,25 +121,28 @@ namespace eds::loli::parsing
         if (auto term = s->AsTerminal(); term)
         {
             output.insert(term);
+            insert_count += 1;
         }
         else
         {
             const auto& source_set = s->AsNonterminal()->FirstSet();
             output.insert(source_set.begin(), source_set.end());
+            insert_count += source_set.size();
         }
 
         // return if output is changed
         return output.size() != old_output_sz;
     }
 
-    // try to insert FOLLOW SET of s into output
-    static bool TryInsertFOLLOW(TerminalSet& output, const Nonterminal* s)
+    // try to insert FOLLOW SET of s into output, where insert_count counts terminals inserted or not
+    static bool TryInsertFOLLOW(TerminalSet& output, const Nonterminal* s, int64_t& insert_count)
     {
         // remember output's size
         const auto old_output_sz = output.size();
 
         // try insert terminals that may follow s into output
         output.insert(s->FollowSet().begin(), s->FollowSet().end());
+        insert_count += s->FollowSet().size();
 
         // return if output is changed
         return output.size() != old_output_sz;
@@ -145,8 +150,13 @@ namespace eds::loli::parsing
 
     void GrammarBuilder::ComputeFirstSet()
     {
+        TraceSpan span{"ComputeFirstSet", "construction"};
+
+        int64_t pass_count   = 0;
+        int64_t insert_count = 0;
+
         // iteratively compute first set until it's not growing
-        for (auto growing = true; growing;)
+        for (auto growing = true; growing; ++pass_count)
         {
             growing = false;
 
@@ -157,7 +167,7 @@ namespace eds::loli::parsing
                 bool may_produce_epsilon = true;
                 for (const auto rhs_elem : production->rhs_)
                 {
-                    growing |= TryInsertFIRST(lhs->first_set_, rhs_elem);
+                    growing |= TryInsertFIRST(lhs->first_set_, rhs_elem, insert_count);
 
                     // break on first non-epsilon-derivable symbol
 
@@ -179,15 +189,27 @@ namespace eds::loli::parsing
                 }
             }
         }
+
+        span.Count("passes", pass_count);
+        span.Count("set_inserts", insert_count);
     }
 
     void GrammarBuilder::ComputeFollowSet()
     {
-        // NOTE root symbol always preceeds eof
+        TraceSpan span{"ComputeFollowSet", "construction"};
+
+        int64_t pass_count   = 0;
+        int64_t insert_count = 0;
+
+        // NOTE root symbol always preceeds eof, so do augmented symbols of entries
         site_->root_symbol_->may_preceed_eof_ = true;
+        for (auto entry : site_->entry_symbols_)
+        {
+            entry->may_preceed_eof_ = true;
+        }
 
         // iteratively compute follow set until it's not growing
-        for (auto growing = true; growing;)
+        for (auto growing = true; growing; ++pass_count)
         {
             growing = false;
 
@@ -209,7 +231,7 @@ namespace eds::loli::parsing
                         const auto next_symbol = *next_iter;
                         if (auto nonterm = next_symbol->AsNonterminal(); nonterm)
                         {
-                            growing |= TryInsertFIRST(nonterm->follow_set_, current_symbol);
+                            growing |= TryInsertFIRST(nonterm->follow_set_, current_symbol, insert_count);
                         }
                     }
 
@@ -232,7 +254,7 @@ namespace eds::loli::parsing
                             }
 
                             // propagate follow_set on epsilon path
-                            growing |= TryInsertFOLLOW(current_nonterm->follow_set_, lhs);
+                            growing |= TryInsertFOLLOW(current_nonterm->follow_set_, lhs, insert_count);
                         }
                         else
                         {
@@ -242,5 +264,8 @@ namespace eds::loli::parsing
                 }
             }
         }
+
+        span.Count("passes", pass_count);
+        span.Count("set_inserts", insert_count);
     }
 }
\ No newline at end of file
@@ -1,9 +1,11 @@
 #include "parsing/parsing-automaton.h"
 #include "parsing/grammar.h"
 #include "container/flat-set.h"
+#include "core/trace.h"
+#include "core/errors.h"
+#include <algorithm>
 #include <set>
 #include <map>
-#include <unordered_set>
 #include <unordered_map>
 #include <tuple>
 #include <cassert>
@@ -45,164 +47,343 @@ namespace eds::loli::parsing
     // Implmentation of ParsingAutomaton
     //
 
-    ParsingState* ParsingAutomaton::MakeState(const ItemSet& items)
+    // NOTE a kernel is hashed once when made, see kernel_hashes_
+    size_t HashKernel(ItemKernel kernel)
     {
-        auto iter = states_.find(items);
-        if (iter == states_.end())
+        uint64_t result = kernel.Length();
+        for (auto item : kernel)
         {
-            auto id = static_cast<int>(states_.size());
-            iter    = states_.try_emplace(iter, items, ParsingState{id});
+            result = (result ^ item) * 0x9e3779b97f4a7c15;
+            result ^= result >> 32;
+        }
+
+        return result;
+    }
+
+    pair<ParsingState*, bool> ParsingAutomaton::MakeState(ItemKernel kernel)
+    {
+        assert(!kernel.Empty() && is_sorted(kernel.begin(), kernel.end()));
+
+        if (2 * (states_.size() + 1) > slots_.size())
+        {
+            GrowSlots();
+        }
+
+        const auto hash = HashKernel(kernel);
+        const auto mask = slots_.size() - 1;
+        for (auto slot = hash & mask;; slot = (slot + 1) & mask)
+        {
+            auto id = slots_[slot];
+            if (id == -1)
+            {
+                // store the new state
+                id           = static_cast<int>(states_.size());
+                slots_[slot] = id;
+
+                kernel_pool_.insert(kernel_pool_.end(), kernel.begin(), kernel.end());
+                kernel_offsets_.push_back(static_cast<int>(kernel_pool_.size()));
+                kernel_hashes_.push_back(hash);
+                states_.emplace_back(id);
+
+                return {&states_.back(), true};
+            }
 
-            // store the new state
-            ptrs_.push_back(&iter->second);
+            if (kernel_hashes_[id] == hash)
+            {
+                auto candidate = LookupKernel(id);
+                if (equal(kernel.begin(), kernel.end(), candidate.begin(), candidate.end()))
+                    return {&states_[id], false};
+            }
         }
+    }
+
+    void ParsingAutomaton::GrowSlots()
+    {
+        slots_.assign(max<size_t>(16, 2 * slots_.size()), -1);
+
+        const auto mask = slots_.size() - 1;
+        for (int id = 0; id < states_.size(); ++id)
+        {
+            auto slot = kernel_hashes_[id] & mask;
+            while (slots_[slot] != -1)
+                slot = (slot + 1) & mask;
 
-        return &(iter->second);
+            slots_[slot] = id;
+        }
     }
 
-    void ParsingAutomaton::EnumerateState(std::function<void(const ItemSet&, ParsingState&)> callback)
+    void ParsingAutomaton::EnumerateState(std::function<void(ItemKernel, ParsingState&)> callback)
     {
-        for (auto& pair : states_)
-            callback(pair.first, pair.second);
+        for (auto& state : states_)
+            callback(LookupKernel(state.Id()), state);
     }
 
     // Construction of Parsing Automaton
     //
 
-    // Expands state of kernel items into its closure
-    // that includes all of non-kernel items as well,
-    // and then enumerate items with a callback
-    template <typename F>
-    void EnumerateClosureItems(const ParsingMetaInfo& info, const ItemSet& kernel, F callback)
+    // Productions pulled into a closure by each variable after a cursor, i.e. those of the variable itself
+    // and of variables leftmost in them transitively, as bitsets over ParsingMetaInfo::Productions(),
+    // so that a closure is the union of those of variables after cursors of its kernel items
+    // NOTE they are computed once per grammar
+    class ClosureCache
     {
-        static_assert(is_invocable_v<F, ParsingItem>);
+    public:
+        ClosureCache(const ParsingMetaInfo& info);
+
+        // Expands state of kernel items into its closure
+        // that includes all of non-kernel items as well,
+        // and then enumerate items with a callback
+        // NOTE non-kernel items are enumerated in order of production after kernel items
+        template <typename F>
+        void EnumerateClosureItems(ItemKernel kernel, F callback);
+
+    private:
+        const ParsingMetaInfo& info_;
+
+        // words of a bitset
+        int word_num_;
+
+        // word_num_ words for each variable in order of id
+        vector<uint64_t> closures_;
+
+        // union of closures of the kernel being expanded
+        vector<uint64_t> buffer_;
+    };
 
-        auto added         = unordered_set<const VariableInfo*>{};
+    ClosureCache::ClosureCache(const ParsingMetaInfo& info)
+        : info_(info)
+    {
+        TraceSpan span{"ComputeClosureCache", "construction"};
+
+        const auto variable_num = info.Variables().Size();
+
+        word_num_ = (info.Productions().Size() + 63) / 64;
+        closures_.assign(variable_num * word_num_, 0);
+        buffer_.assign(word_num_, 0);
+
+        auto added         = vector<bool>{};
         auto to_be_visited = vector<const VariableInfo*>{};
+        for (const auto& root : info.Variables())
+        {
+            const auto closure = closures_.data() + root.Id() * word_num_;
 
-        // TODO: SUSPICIOUS TO BUGS, ROOT SYMBOL SHOULD BE TREATED DIFFERENTLY
-        // treat root symbol's items as kernel
-        // added.insert(&info.RootSymbol());
+            // helper
+            const auto try_register_candidate = [&](const VariableInfo* candidate) {
+                if (!added[candidate->Id()])
+                {
+                    added[candidate->Id()] = true;
+                    to_be_visited.push_back(candidate);
+                }
+            };
 
-        // helper
-        const auto try_register_candidate = [&](const SymbolInfo* s) {
-            if (auto candidate = s->AsVariable(); candidate)
+            added.assign(variable_num, false);
+            try_register_candidate(&root);
+
+            // collect productions of variables reachable via the leftmost symbol
+            while (!to_be_visited.empty())
             {
-                if (added.count(candidate) == 0)
+                auto variable = to_be_visited.back();
+                to_be_visited.pop_back();
+
+                for (const auto& p : variable->Productions())
                 {
-                    added.insert(candidate);
-                    to_be_visited.push_back(candidate);
+                    closure[p->Id() / 64] |= uint64_t{1} << (p->Id() % 64);
+
+                    if (!p->Right().empty())
+                    {
+                        if (auto candidate = p->Right().front()->AsVariable(); candidate)
+                            try_register_candidate(candidate);
+                    }
                 }
             }
-        };
+        }
+
+        span.Count("variables", variable_num);
+        span.Count("closure_bytes", closures_.size() * sizeof(uint64_t));
+    }
+
+    template <typename F>
+    void ClosureCache::EnumerateClosureItems(ItemKernel kernel, F callback)
+    {
+        static_assert(is_invocable_v<F, ParsingItem>);
 
-        // visit kernel items and record nonterms for closure calculation
-        for (const auto& item : kernel)
+        fill(buffer_.begin(), buffer_.end(), 0);
+
+        // visit kernel items and merge closures of nonterms after their cursor
+        for (auto packed : kernel)
         {
+            const auto item = UnpackItem(info_, packed);
             callback(item);
 
             // Item{ A -> \alpha . }: skip it
-            // Item{ A -> \alpha . B \gamma }: queue unvisited nonterm B for further expansion
+            // Item{ A -> \alpha . B \gamma }: merge closure of nonterm B
             if (auto s = item.NextSymbol(); s)
             {
-                try_register_candidate(s);
+                if (auto variable = s->AsVariable(); variable)
+                {
+                    const auto closure = closures_.data() + variable->Id() * word_num_;
+                    for (int i = 0; i < word_num_; ++i)
+                    {
+                        buffer_[i] |= closure[i];
+                    }
+                }
             }
         }
 
-        // genreate and visit non-kernel items recursively
-        while (!to_be_visited.empty())
+        // NOTE the initial kernel has items of P -> . \alpha, which should not be visited twice
+        for (auto packed : kernel)
         {
-            auto variable = to_be_visited.back();
-            to_be_visited.pop_back();
-
-            for (const auto& p : variable->Productions())
+            const auto item = UnpackItem(info_, packed);
+            if (!item.IsKernel())
             {
-                callback(ParsingItem{p, 0});
+                const auto id = item.Production()->Id();
+                buffer_[id / 64] &= ~(uint64_t{1} << (id % 64));
+            }
+        }
 
-                if (!p->Right().empty())
-                {
-                    try_register_candidate(p->Right().front());
-                }
+        // visit non-kernel items
+        for (int i = 0; i < word_num_; ++i)
+        {
+            int bit = 0;
+            for (auto word = buffer_[i]; word != 0; word >>= 1, ++bit)
+            {
+                if (word & 1)
+                    callback(ParsingItem{&info_.Productions()[i * 64 + bit], 0});
             }
         }
     }
 
-    // claculate target state from a source state with a particular symbol s
-    // and enumerate its items with a callback
-    ItemSet ComputeGotoItems(const ParsingMetaInfo& info, const ItemSet& src, const SymbolInfo* s)
+    vector<PackedItem> GenerateInitialItems(const ParsingMetaInfo& info)
     {
-        ItemSet new_state;
-
-        EnumerateClosureItems(info, src, [&](ParsingItem item) {
+        vector<PackedItem> result;
+        for (auto p : info.RootSymbol().Productions())
+        {
+            result.push_back(PackItem(ParsingItem{p, 0}));
+        }
 
-            // for Item A -> \alpha . B \beta where B == s, advance the cursor
-            if (item.NextSymbol() == s)
+        // items of augmented productions make the initial state lead to each entry via its marker
+        for (const auto& entry : info.Entries())
+        {
+            for (auto p : entry.augmented->Productions())
             {
-                new_state.insert(item.CreateSuccessor());
+                result.push_back(PackItem(ParsingItem{p, 0}));
             }
-        });
+        }
 
-        return new_state;
+        sort(result.begin(), result.end());
+        result.erase(unique(result.begin(), result.end()), result.end());
+        return result;
     }
 
-    ItemSet GenerateInitialItems(const ParsingMetaInfo& info)
+    // productions and their right-hand sides should be few enough to pack items, see PackedItem
+    void VerifyItemPacking(const ParsingMetaInfo& info)
     {
-        ItemSet result;
-        for (auto p : info.RootSymbol().Productions())
+        if (info.Productions().Size() > (1u << (32 - item_cursor_bits)))
+            throw ParserConstructionError{"BootstrapParsingAutomaton: too many productions"};
+
+        for (const auto& p : info.Productions())
         {
-            result.insert(ParsingItem{p, 0});
+            if (p.Right().size() >= (1u << item_cursor_bits))
+                throw ParserConstructionError{"BootstrapParsingAutomaton: too many symbols in a production"};
         }
-
-        return result;
     }
 
-    template <typename F>
-    void EnumerateSymbols(const ParsingMetaInfo& info, F callback)
+    // augmented symbols of entries, which are not versioned as root, see ParsingMetaInfo::EntryInfo
+    vector<Nonterminal*> MakeEntrySymbols(const ParsingMetaInfo& info, GrammarBuilder& builder)
     {
-        static_assert(is_invocable_v<F, const SymbolInfo*>);
-
-        for (const auto& tok : info.Tokens())
-            callback(&tok);
+        vector<Nonterminal*> result;
+        for (const auto& entry : info.Entries())
+        {
+            result.push_back(builder.MakeNonterminal(entry.augmented, nullptr));
+        }
 
-        for (const auto& var : info.Variables())
-            callback(&var);
+        return result;
     }
 
-    auto BootstrapParsingAutomaton(const ParsingMetaInfo& info)
+    auto BootstrapParsingAutomaton(const ParsingMetaInfo& info, ClosureCache& closure)
     {
-        // NOTE a set of ParsingItem coresponds to a ParsingState
+        TraceSpan span{"BootstrapParsingAutomaton", "construction"};
+
+        VerifyItemPacking(info);
+
+        // NOTE a kernel of ParsingItem coresponds to a ParsingState
         auto pda = make_unique<ParsingAutomaton>();
 
-        auto initial_set = GenerateInitialItems(info);
+        auto initial_items = GenerateInitialItems(info);
+        pda->MakeState(ItemKernel(initial_items.data(), initial_items.size()));
 
-        // for each unvisited LR state, generate a target state for each possible symbol
-        for (deque<ItemSet> unprocessed{initial_set}; !unprocessed.empty(); unprocessed.pop_front())
-        {
-            const auto& src_items = unprocessed.front();
-            const auto src_state  = pda->MakeState(src_items);
+        int64_t closure_count    = 0;
+        int64_t item_count       = initial_items.size();
+        int64_t transition_count = 0;
+
+        // symbols are indexed as tokens followed by variables
+        const int token_num  = info.Tokens().Size();
+        const int symbol_num = token_num + info.Variables().Size();
 
-            EnumerateSymbols(info, [&](const SymbolInfo* s) {
+        const auto index_of = [&](const SymbolInfo* s) {
+            if (auto tok = s->AsToken(); tok)
+                return tok->Id();
+            else
+                return token_num + s->AsVariable()->Id();
+        };
+        const auto symbol_at = [&](int index) -> const SymbolInfo* {
+            if (index < token_num)
+                return &info.Tokens()[index];
+            else
+                return &info.Variables()[index - token_num];
+        };
 
-                // calculate the target state for symbol s
-                auto dest_items = ComputeGotoItems(info, src_items, s);
+        // kernel items of target states for each symbol, and indices of symbols with any
+        auto dest_items   = vector<vector<PackedItem>>(symbol_num);
+        auto dest_symbols = vector<int>{};
 
-                // empty set of item is not a valid state
-                if (dest_items.empty()) return;
+        // for each unvisited LR state, generate a target state for each possible symbol
+        // NOTE states are created in order of id, so those not visited yet are always at the back
+        for (int src_id = 0; src_id < pda->StateCount(); ++src_id)
+        {
+            const auto src_state = pda->LookupState(src_id);
 
-                // compute target state
-                auto old_state_cnt = pda->States().size();
-                auto dest_state    = pda->MakeState(dest_items);
-                if (pda->States().size() > old_state_cnt)
+            // for Item A -> \alpha . B \beta, advance the cursor into target items for symbol B
+            closure.EnumerateClosureItems(pda->LookupKernel(src_id), [&](ParsingItem item) {
+                if (auto s = item.NextSymbol(); s)
                 {
-                    // if dest_state is newly created, pipe it into unprocessed queue
-                    unprocessed.push_back(dest_items);
+                    auto& items = dest_items[index_of(s)];
+                    if (items.empty())
+                        dest_symbols.push_back(index_of(s));
+
+                    items.push_back(PackItem(item.CreateSuccessor()));
                 }
+            });
+            closure_count += 1;
+
+            // NOTE target states are made in order of symbol, so that ids are stable
+            sort(dest_symbols.begin(), dest_symbols.end());
+            for (auto index : dest_symbols)
+            {
+                // NOTE items of a closure are unique, so are their successors
+                auto& items = dest_items[index];
+                sort(items.begin(), items.end());
+
+                item_count += items.size();
+                transition_count += 1;
+
+                // compute target state, which is visited later if newly created
+                auto dest_state = pda->MakeState(ItemKernel(items.data(), items.size())).first;
 
                 // add transition
-                src_state->RegisterShift(dest_state, s);
-            });
+                src_state->RegisterShift(dest_state, symbol_at(index));
+
+                items.clear();
+            }
+
+            dest_symbols.clear();
         }
 
+        span.Count("states", pda->StateCount());
+        span.Count("transitions", transition_count);
+        span.Count("closure_invocations", closure_count);
+        span.Count("kernel_items", item_count);
+
         return pda;
     }
 
@@ -224,20 +405,23 @@ namespace eds::loli::parsing
             builder.CreateProduction(&p, lhs, rhs);
         }
 
-        auto root = builder.MakeNonterminal(&info.RootSymbol(), nullptr);
-        return builder.Build(root);
+        auto root    = builder.MakeNonterminal(&info.RootSymbol(), nullptr);
+        auto entries = MakeEntrySymbols(info, builder);
+        return builder.Build(root, entries);
     }
 
     unique_ptr<const ParsingAutomaton> BuildSLRAutomaton(const ParsingMetaInfo& info)
     {
-        auto pda = BootstrapParsingAutomaton(info);
+        auto closure = ClosureCache{info};
+        auto pda     = BootstrapParsingAutomaton(info, closure);
 
         // calculate FIRST and FOLLOW set first
         const auto grammar = CreateSimpleGrammar(info);
 
-        pda->EnumerateState([&](const ItemSet& items, ParsingState& state) {
-            for (auto item : items)
+        pda->EnumerateState([&](ItemKernel items, ParsingState& state) {
+            for (auto packed : items)
             {
+                const auto item = UnpackItem(info, packed);
                 if (item.IsFinalized())
                 {
                     // shortcuts
@@ -283,12 +467,17 @@ namespace eds::loli::parsing
         }
     }
 
-    unique_ptr<Grammar> CreateExtendedGrammar(const ParsingMetaInfo& info, ParsingAutomaton& pda)
+    unique_ptr<Grammar> CreateExtendedGrammar(const ParsingMetaInfo& info, ClosureCache& closure, ParsingAutomaton& pda)
     {
+        TraceSpan span{"CreateExtendedGrammar", "construction"};
+
         GrammarBuilder builder;
 
+        int64_t closure_count = 0;
+        int64_t item_count    = 0;
+
         // extend symbols
-        pda.EnumerateState([&](const ItemSet& items, ParsingState& state) {
+        pda.EnumerateState([&](ItemKernel items, ParsingState& state) {
             // extend nonterms
             for (const auto& goto_edge : state.GotoMap())
             {
@@ -308,11 +497,20 @@ namespace eds::loli::parsing
             }
         });
 
-        auto new_root = builder.MakeNonterminal(&info.RootVariable(), nullptr);
+        auto new_root    = builder.MakeNonterminal(&info.RootVariable(), nullptr);
+        auto new_entries = MakeEntrySymbols(info, builder);
+
+        auto is_start_symbol = [&](const VariableInfo* var) {
+            return var == new_root->Info() ||
+                   any_of(new_entries.begin(), new_entries.end(), [&](Nonterminal* entry) { return var == entry->Info(); });
+        };
 
         // extend productions
-        pda.EnumerateState([&](const ItemSet& items, ParsingState& state) {
-            EnumerateClosureItems(info, items, [&](ParsingItem item) {
+        pda.EnumerateState([&](ItemKernel items, ParsingState& state) {
+            closure_count += 1;
+
+            closure.EnumerateClosureItems(items, [&](ParsingItem item) {
+                item_count += 1;
 
                 // NOTE we are only interested in non-kernel items(including intial state)
                 // to avoid repetition
@@ -322,15 +520,13 @@ namespace eds::loli::parsing
                 const auto& production_info = item.Production();
 
                 // map left-hand side
-                auto lhs = new_root;
-                if (state.Id() != 0 || production_info->Left() != new_root->Info())
-                {
-                    // TODO: remove hard-coded state id 0
-
-                    // exclude root nonterm because its version is set to nullptr
-                    auto version = LookupTargetState(&state, production_info->Left());
-                    lhs          = builder.MakeNonterminal(production_info->Left(), version);
-                }
+                // TODO: remove hard-coded state id 0
+                // NOTE start nonterms in the initial state are excluded because their versions are set to nullptr
+                const auto& lhs_info = production_info->Left();
+                auto version         = state.Id() == 0 && is_start_symbol(lhs_info)
+                                   ? nullptr
+                                   : LookupTargetState(&state, lhs_info);
+                auto lhs = builder.MakeNonterminal(lhs_info, version);
 
                 // map right-hand side
                 vector<Symbol*> rhs = {};
@@ -362,13 +558,24 @@ namespace eds::loli::parsing
             });
         });
 
-        return builder.Build(new_root);
+        span.Count("closure_invocations", closure_count);
+        span.Count("closure_items", item_count);
+
+        auto result = builder.Build(new_root, new_entries);
+        span.Count("productions", result->Productions().size());
+
+        return result;
     }
 
     unique_ptr<const ParsingAutomaton> BuildLALRAutomaton(const ParsingMetaInfo& info)
     {
-        auto pda         = BootstrapParsingAutomaton(info);
-        auto ext_grammar = CreateExtendedGrammar(info, *pda);
+        TraceSpan span{"BuildLALRAutomaton", "construction"};
+
+        auto closure     = ClosureCache{info};
+        auto pda         = BootstrapParsingAutomaton(info, closure);
+        auto ext_grammar = CreateExtendedGrammar(info, closure, *pda);
+
+        TraceSpan merging_span{"MergeLookaheads", "construction"};
 
         // (state where reduction is done, production)
         using LocatedProduction = tuple<const ParsingState*, const ProductionInfo*>;
@@ -398,10 +605,13 @@ namespace eds::loli::parsing
             }
         }
 
+        int64_t reduction_count = 0;
+
         // register reductions
-        pda->EnumerateState([&](const ItemSet& items, ParsingState& state) {
-            for (auto item : items)
+        pda->EnumerateState([&](ItemKernel items, ParsingState& state) {
+            for (auto packed : items)
             {
+                const auto item = UnpackItem(info, packed);
                 const auto& production = item.Production();
                 auto key               = LocatedProduction{&state, production};
 
@@ -417,11 +627,15 @@ namespace eds::loli::parsing
                     for (auto term : merged_follow.at(key))
                     {
                         state.RegisterReduce(production, term);
+                        reduction_count += 1;
                     }
                 }
             }
         });
 
+        merging_span.Count("located_productions", merged_follow.size());
+        merging_span.Count("reductions", reduction_count);
+
         return pda;
     }
 }
\ No newline at end of file